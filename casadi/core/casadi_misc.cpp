@@ -353,9 +353,12 @@ std::string simple_mkstemps(const std::string& prefix, const std::string& suffix
     #ifdef HAVE_MKSTEMPS
     // Preferred solution
     std::string ret = prefix + "XXXXXX" + suffix;
-    if (mkstemps(&ret[0], static_cast<int>(suffix.size())) == -1) {
+    int fd = mkstemps(&ret[0], static_cast<int>(suffix.size()));
+    if (fd == -1) {
       casadi_error("Failed to create temporary file: '" + ret + "'");
     }
+    // Only the name is returned, callers reopen the file
+    close(fd);
     return ret;
     #else // HAVE_MKSTEMPS
     #ifdef HAVE_SIMPLE_MKSTEMPS
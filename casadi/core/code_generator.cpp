@@ -30,6 +30,7 @@
 #include <casadi_runtime_str.h>
 #include "global_options.hpp"
 #include <iomanip>
+#include <algorithm>
 
 namespace casadi {
 
@@ -57,6 +58,7 @@ namespace casadi {
     this->prefix = "";
     this->max_declarations_per_line = 12;
     this->max_initializer_elements_per_line = 8;
+    this->unit_size = 0;
 
     avoid_stack_ = false;
     indent_ = 2;
@@ -117,6 +119,9 @@ namespace casadi {
         this->max_initializer_elements_per_line = e.second;
         casadi_assert(this->max_initializer_elements_per_line>=0,
           "Option max_initializer_elements_per_line must be >=0");
+      } else if (e.first=="unit_size") {
+        this->unit_size = e.second;
+        casadi_assert(this->unit_size>=0, "Option unit_size must be >=0");
       } else {
         casadi_error("Unrecognized option: " + str(e.first));
       }
@@ -143,6 +148,7 @@ namespace casadi {
 
     // Start off without the need for thread-local memory
     needs_mem_ = false;
+    unit_start_ = -1;
 
     // Divide name into base and suffix (if any)
     std::string::size_type dotpos = name.rfind('.');
@@ -473,8 +479,104 @@ namespace casadi {
     std::string fullname = prefix + this->name + this->suffix;
     file_open(s, fullname, this->cpp);
 
-    // Dump code to file
-    dump(s);
+    // Segments moved to separate translation units
+    units_.clear();
+    if (!unit_segments_.empty()) {
+      // File scope work is shared and cannot be split
+      bool split = file_scope_double_.empty() && file_scope_integer_.empty();
+      std::string body = this->body.str();
+      // Code of each file, the main file first
+      std::vector<std::string> code(1);
+      // File defining the function of each segment
+      std::vector<casadi_int> def_file;
+      std::streamoff pos = 0;
+      casadi_int unit_lines = 0;
+      for (auto&& seg : unit_segments_) {
+        if (!split) {
+          def_file.push_back(0);
+          continue;
+        }
+        code[0].append(body, pos, seg.first - pos);
+        std::string c = body.substr(seg.first, seg.second - seg.first);
+        // Start a new unit when full, packing consecutive segments
+        if (code.size()==1 || unit_lines >= this->unit_size) {
+          code.push_back("");
+          unit_lines = 0;
+        }
+        unit_lines += std::count(c.begin(), c.end(), '\n');
+        code.back() += c;
+        def_file.push_back(code.size()-1);
+        pos = seg.second;
+      }
+      code[0].append(body, pos, std::string::npos);
+
+      // Internal symbols used by each file
+      std::vector<std::set<std::string> > used;
+      for (auto&& c : code) used.push_back(casadi_identifiers(c));
+
+      // Functions only called from the defining file remain static
+      file_declarations_.assign(code.size(), "");
+      for (casadi_int i=0; i<unit_functions_.size(); ++i) {
+        const std::string& fname = unit_functions_[i].first;
+        const std::string& decl = unit_functions_[i].second;
+        bool shared = false;
+        for (casadi_int f=0; f<code.size(); ++f) {
+          if (f!=def_file[i] && used[f].count(fname)) shared = true;
+        }
+        if (!shared) {
+          std::string& c = code[def_file[i]];
+          size_t n = c.find(decl + " {");
+          casadi_assert_dev(n!=std::string::npos);
+          c.insert(n, "static ");
+        }
+        for (casadi_int f=0; f<code.size(); ++f) {
+          if (used[f].count(fname)) {
+            file_declarations_[f] += (shared ? "extern " : "static ") + decl + ";\n";
+          }
+        }
+      }
+
+      // Constants used by several files are defined once, in the first of them
+      file_constants_.assign(code.size(), "");
+      for (auto&& c : constant_definitions()) {
+        std::vector<casadi_int> users;
+        for (casadi_int f=0; f<code.size(); ++f) {
+          if (used[f].count(c.first)) users.push_back(f);
+        }
+        if (users.empty()) users.push_back(0);
+        // Empty constants are null pointers, cheap to define in every file
+        bool empty = c.second.find('[')==std::string::npos;
+        if (users.size()==1 || empty) {
+          for (casadi_int f : users) file_constants_[f] += c.second;
+        } else {
+          // Drop "static ", definitions of const objects need "extern" in C++
+          std::string def = c.second.substr(7);
+          file_constants_[users[0]] += (this->cpp ? "extern " : "") + def;
+          std::string decl = "extern " + def.substr(0, def.find(" = ")) + ";\n";
+          for (casadi_int k=1; k<users.size(); ++k) file_constants_[users[k]] += decl;
+        }
+      }
+
+      // Main file
+      dump_prologue(s);
+      s << code[0] << std::endl;
+
+      // Other units
+      for (casadi_int k=0; k+1<code.size(); ++k) {
+        std::ofstream u;
+        std::string uname = prefix + this->name + "_u" + str(k) + this->suffix;
+        file_open(u, uname, this->cpp);
+        dump_prologue(u, k);
+        u << code[k+1] << std::endl;
+        file_close(u, this->cpp);
+        units_.push_back(uname);
+      }
+      file_constants_.clear();
+      file_declarations_.clear();
+    } else {
+      // Dump code to file
+      dump(s);
+    }
 
     // Mex entry point
     if (this->mex) generate_mex(s);
@@ -807,6 +909,17 @@ namespace casadi {
   }
 
   void CodeGenerator::dump(std::ostream& s) {
+    // Everything preceding the function bodies
+    dump_prologue(s);
+
+    // Codegen body
+    s << this->body.str();
+
+    // End with new line
+    s << std::endl;
+  }
+
+  void CodeGenerator::dump_prologue(std::ostream& s, casadi_int unit) {
     // Consistency check
     casadi_assert_dev(current_indent_ == 0);
 
@@ -851,7 +964,7 @@ namespace casadi {
       s << std::endl;
     }
 
-    if (this->with_export) generate_export_symbol(s);
+    if (this->with_export && unit<0) generate_export_symbol(s);
 
     // Check if inf/nan is needed
     for (const auto& d : double_constants_) {
@@ -861,51 +974,60 @@ namespace casadi {
       }
     }
 
-    // Codegen auxiliary functions
-    s << this->auxiliaries.str();
+    // Codegen auxiliary functions, defined in the main file only
+    if (unit<0) {
+      s << this->auxiliaries.str();
+    } else {
+      s << prototypes(this->auxiliaries.str());
+    }
 
-    // Print integer constants
-    if (!integer_constants_.empty()) {
-      for (casadi_int i=0; i<integer_constants_.size(); ++i) {
-        print_vector(s, "casadi_s" + str(i), integer_constants_[i]);
+    if (!file_constants_.empty()) {
+      // Constants of a split generation
+      s << file_constants_.at(unit+1) << std::endl;
+    } else {
+      // Print integer constants
+      if (!integer_constants_.empty()) {
+        for (casadi_int i=0; i<integer_constants_.size(); ++i) {
+          print_vector(s, "casadi_s" + str(i), integer_constants_[i]);
+        }
+        s << std::endl;
       }
-      s << std::endl;
-    }
 
-    // Print double constants
-    if (!double_constants_.empty()) {
-      for (casadi_int i=0; i<double_constants_.size(); ++i) {
-        print_vector(s, "casadi_c" + str(i), double_constants_[i]);
+      // Print double constants
+      if (!double_constants_.empty()) {
+        for (casadi_int i=0; i<double_constants_.size(); ++i) {
+          print_vector(s, "casadi_c" + str(i), double_constants_[i]);
+        }
+        s << std::endl;
       }
-      s << std::endl;
-    }
 
-    // Print char constants
-    if (!char_constants_.empty()) {
-      for (casadi_int i=0; i<char_constants_.size(); ++i) {
-        print_vector(s, "casadi_b" + str(i), char_constants_[i]);
+      // Print char constants
+      if (!char_constants_.empty()) {
+        for (casadi_int i=0; i<char_constants_.size(); ++i) {
+          print_vector(s, "casadi_b" + str(i), char_constants_[i]);
+        }
+        s << std::endl;
       }
-      s << std::endl;
-    }
 
-    // Print string constants
-    if (!string_constants_.empty()) {
-      for (casadi_int i=0; i<string_constants_.size(); ++i) {
-        print_vector(s, "casadi_a" + str(i), string_constants_[i]);
+      // Print string constants
+      if (!string_constants_.empty()) {
+        for (casadi_int i=0; i<string_constants_.size(); ++i) {
+          print_vector(s, "casadi_a" + str(i), string_constants_[i]);
+        }
+        s << std::endl;
       }
-      s << std::endl;
-    }
 
-    if (sz_zeros_) {
-      std::vector<double> sz_zeros(sz_zeros_, 0);
-      print_vector(s, "casadi_zeros", std::vector<double>(sz_zeros));
-      s << std::endl;
-    }
+      if (sz_zeros_) {
+        std::vector<double> sz_zeros(sz_zeros_, 0);
+        print_vector(s, "casadi_zeros", std::vector<double>(sz_zeros));
+        s << std::endl;
+      }
 
-    if (sz_ones_) {
-      std::vector<double> sz_ones(sz_ones_, 0);
-      print_vector(s, "casadi_ones", std::vector<double>(sz_ones));
-      s << std::endl;
+      if (sz_ones_) {
+        std::vector<double> sz_ones(sz_ones_, 0);
+        print_vector(s, "casadi_ones", std::vector<double>(sz_ones));
+        s << std::endl;
+      }
     }
 
     // Print file scope double work
@@ -935,11 +1057,132 @@ namespace casadi {
       s << std::endl << std::endl;
     }
 
-    // Codegen body
-    s << this->body.str();
+    // Declarations of the functions that may be moved to separate units
+    if (!file_declarations_.empty()) {
+      s << "/* Function declarations */\n";
+      s << file_declarations_.at(unit+1) << std::endl;
+    }
+  }
 
-    // End with new line
-    s << std::endl;
+  std::vector<std::pair<std::string, std::string> > CodeGenerator::constant_definitions() {
+    std::vector<std::pair<std::string, std::string> > ret;
+    std::stringstream ss;
+    for (casadi_int i=0; i<integer_constants_.size(); ++i) {
+      ss.str("");
+      print_vector(ss, "casadi_s" + str(i), integer_constants_[i]);
+      ret.push_back(std::make_pair("casadi_s" + str(i), ss.str()));
+    }
+    for (casadi_int i=0; i<double_constants_.size(); ++i) {
+      ss.str("");
+      print_vector(ss, "casadi_c" + str(i), double_constants_[i]);
+      ret.push_back(std::make_pair("casadi_c" + str(i), ss.str()));
+    }
+    for (casadi_int i=0; i<char_constants_.size(); ++i) {
+      ss.str("");
+      print_vector(ss, "casadi_b" + str(i), char_constants_[i]);
+      ret.push_back(std::make_pair("casadi_b" + str(i), ss.str()));
+    }
+    for (casadi_int i=0; i<string_constants_.size(); ++i) {
+      ss.str("");
+      print_vector(ss, "casadi_a" + str(i), string_constants_[i]);
+      ret.push_back(std::make_pair("casadi_a" + str(i), ss.str()));
+    }
+    if (sz_zeros_) {
+      ss.str("");
+      print_vector(ss, "casadi_zeros", std::vector<double>(sz_zeros_, 0));
+      ret.push_back(std::make_pair("casadi_zeros", ss.str()));
+    }
+    if (sz_ones_) {
+      ss.str("");
+      print_vector(ss, "casadi_ones", std::vector<double>(sz_ones_, 0));
+      ret.push_back(std::make_pair("casadi_ones", ss.str()));
+    }
+    return ret;
+  }
+
+  std::set<std::string> CodeGenerator::casadi_identifiers(const std::string& code) {
+    std::set<std::string> ret;
+    for (size_t i=0; i<code.size(); ) {
+      if (isalpha(code[i]) || code[i]=='_') {
+        size_t n = i;
+        while (n<code.size() && (isalnum(code[n]) || code[n]=='_')) ++n;
+        if (code.compare(i, 7, "casadi_")==0) ret.insert(code.substr(i, n-i));
+        i = n;
+      } else {
+        ++i;
+      }
+    }
+    return ret;
+  }
+
+  std::string CodeGenerator::prototypes(const std::string& src) {
+    std::string ret, head;
+    bool has_paren = false;
+    for (size_t i=0; i<src.size(); ++i) {
+      char c = src[i];
+      if (c=='#' && head.find_first_not_of(" \n")==std::string::npos) {
+        // Preprocessor directives are kept, including continuation lines
+        size_t e = i;
+        while ((e = src.find('\n', e))!=std::string::npos && src[e-1]=='\\') ++e;
+        if (e==std::string::npos) e = src.size()-1;
+        ret += head + src.substr(i, e-i+1);
+        head.clear();
+        i = e;
+      } else if (c=='/' && i+1<src.size() && src[i+1]=='*') {
+        // Comments are kept
+        size_t e = std::min(src.find("*/", i+2), src.size()-2) + 1;
+        head += src.substr(i, e-i+1);
+        i = e;
+      } else if (c==';') {
+        ret += head + c;
+        head.clear();
+        has_paren = false;
+      } else if (c=='{') {
+        // Find the matching brace, skipping literals and comments
+        casadi_int depth = 0;
+        size_t e;
+        for (e=i; e<src.size(); ++e) {
+          char d = src[e];
+          if (d=='"' || d=='\'') {
+            for (++e; e<src.size() && src[e]!=d; ++e) if (src[e]=='\\') ++e;
+          } else if (d=='/' && e+1<src.size() && src[e+1]=='*') {
+            e = std::min(src.find("*/", e+2), src.size()-2) + 1;
+          } else if (d=='{') {
+            depth++;
+          } else if (d=='}' && --depth==0) {
+            break;
+          }
+        }
+        if (has_paren) {
+          // Function definition, keep the signature only
+          ret += head.substr(0, head.find_last_not_of(" \n")+1) + ";";
+        } else {
+          // Type definition
+          ret += head + src.substr(i, e-i+1);
+        }
+        head.clear();
+        has_paren = false;
+        i = e;
+      } else {
+        if (c=='(') has_paren = true;
+        head += c;
+      }
+    }
+    return ret + head;
+  }
+
+  void CodeGenerator::unit_begin() {
+    casadi_assert_dev(unit_start_<0);
+    flush(this->body);
+    unit_start_ = this->body.tellp();
+  }
+
+  void CodeGenerator::unit_end(const std::string& fname, const std::string& decl) {
+    casadi_assert_dev(unit_start_>=0);
+    flush(this->body);
+    unit_segments_.push_back(std::make_pair(unit_start_, std::streamoff(this->body.tellp())));
+    unit_functions_.push_back(std::make_pair(fname, decl));
+    unit_start_ = -1;
   }
 
   std::string CodeGenerator::work(casadi_int n, casadi_int sz, bool is_ref) const {
@@ -2388,6 +2631,18 @@ namespace casadi {
            + beta + ", " + prinv + ", " + pc + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  qr_solve_block(const std::string& x, casadi_int nrhs, bool tr,
+      const std::string& sp_v, const std::string& v,
+      const std::string& sp_r, const std::string& r,
+      const std::string& beta, const std::string& prinv,
+      const std::string& pc, const std::string& w, casadi_int nb) {
+    add_auxiliary(CodeGenerator::AUX_QR);
+    return "casadi_qr_solve_block(" + x + ", " + str(nrhs) + ", " + (tr ? "1" : "0") + ", "
+           + sp_v + ", " + v + ", " + sp_r + ", " + r + ", "
+           + beta + ", " + prinv + ", " + pc + ", " + w + ", " + str(nb) + ");";
+  }
+
   std::string CodeGenerator::
   lsqr_solve(const std::string& A, const std::string&x,
              casadi_int nrhs, bool tr, const std::string& sp, const std::string& w) {
@@ -2405,6 +2660,15 @@ namespace casadi {
            + d + ", " + p + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  ldl_sn(const std::string& sn, const std::string& a,
+         const std::string& lt, const std::string& d, const std::string& v,
+         const std::string& w, const std::string& iw) {
+    add_auxiliary(CodeGenerator::AUX_LDL);
+    return "casadi_ldl_sn(" + sn + ", " + a + ", " + lt + ", " + d + ", "
+           + v + ", " + w + ", " + iw + ");";
+  }
+
   std::string CodeGenerator::
   ldl_solve(const std::string& x, casadi_int nrhs,
     const std::string& sp_lt, const std::string& lt, const std::string& d,
@@ -2414,6 +2678,15 @@ namespace casadi {
            + lt + ", " + d + ", " + p + ", " + w + ");";
   }
 
+  std::string CodeGenerator::
+  ldl_solve_block(const std::string& x, casadi_int nrhs,
+    const std::string& sp_lt, const std::string& lt, const std::string& d,
+    const std::string& p, const std::string& w, casadi_int nb) {
+    add_auxiliary(CodeGenerator::AUX_LDL);
+    return "casadi_ldl_solve_block(" + x + ", " + str(nrhs) + ", " + sp_lt + ", "
+           + lt + ", " + d + ", " + p + ", " + w + ", " + str(nb) + ");";
+  }
+
   std::string CodeGenerator::
   fmax(const std::string& x, const std::string& y) {
     add_auxiliary(CodeGenerator::AUX_FMAX);
@@ -65,6 +65,12 @@ namespace casadi {
         \identifier{rv} */
     std::string generate(const std::string& prefix="");
 
+    /** \brief Additional translation units written by generate
+
+      Only nonempty when the "unit_size" option is set. The units are to be
+      compiled separately and linked together with the main file. */
+    std::vector<std::string> units() const { return units_;}
+
     /// Add an include file optionally using a relative path "..." instead of an absolute path <...>
     void add_include(const std::string& new_include, bool relative_path=false,
                     const std::string& use_ifdef=std::string());
@@ -76,6 +82,12 @@ namespace casadi {
     /// Add an external function declaration
     void add_external(const std::string& new_external);
 
+    /// Start a segment of code that may be moved to a separate translation unit
+    void unit_begin();
+
+    /// End such a segment, defining the function fname with signature decl
+    void unit_end(const std::string& fname, const std::string& decl);
+
     /// Get a shorthand
     std::string shorthand(const std::string& name) const;
 
@@ -434,6 +446,13 @@ namespace casadi {
                          const std::string& beta, const std::string& prinv,
                          const std::string& pc, const std::string& w);
 
+    /** \brief Blocked QR solve, processing nb right-hand sides at a time */
+    std::string qr_solve_block(const std::string& x, casadi_int nrhs, bool tr,
+                               const std::string& sp_v, const std::string& v,
+                               const std::string& sp_r, const std::string& r,
+                               const std::string& beta, const std::string& prinv,
+                               const std::string& pc, const std::string& w, casadi_int nb);
+
     /** \\brief LSQR solve
 
          \identifier{t1} */
@@ -448,6 +467,12 @@ namespace casadi {
                    const std::string& d, const std::string& p,
                    const std::string& w);
 
+    /** \brief Supernodal LDL factorization */
+    std::string ldl_sn(const std::string& sn, const std::string& a,
+                       const std::string& lt, const std::string& d,
+                       const std::string& v, const std::string& w,
+                       const std::string& iw);
+
     /** \brief LDL solve
 
         \identifier{t3} */
@@ -456,6 +481,12 @@ namespace casadi {
                          const std::string& d, const std::string& p,
                          const std::string& w);
 
+    /** \brief Blocked LDL solve, processing nb right-hand sides at a time */
+    std::string ldl_solve_block(const std::string& x, casadi_int nrhs,
+                                const std::string& sp_lt, const std::string& lt,
+                                const std::string& d, const std::string& p,
+                                const std::string& w, casadi_int nb);
+
     /** \brief fmax
 
         \identifier{t4} */
@@ -857,6 +888,18 @@ namespace casadi {
     // Generate import symbol macros
     void generate_import_symbol(std::ostream &s) const;
 
+    // Generate everything preceding the function bodies, unit -1 for the main file
+    void dump_prologue(std::ostream& s, casadi_int unit=-1);
+
+    // Names and definitions of the constants
+    std::vector<std::pair<std::string, std::string> > constant_definitions();
+
+    // Identifiers starting with "casadi_" in a piece of code
+    static std::set<std::string> casadi_identifiers(const std::string& code);
+
+    // Replace function definitions with declarations
+    static std::string prototypes(const std::string& src);
+
     //  private:
   public:
     /// \cond INTERNAL
@@ -923,6 +966,9 @@ namespace casadi {
     // Maximum number of initializer elements per line
     casadi_int max_initializer_elements_per_line;
 
+    // Approximate number of lines per translation unit, zero for a single file
+    casadi_int unit_size;
+
     // Prefix symbols in DLLs?
     std::string dll_export, dll_import;
 
@@ -990,6 +1036,19 @@ namespace casadi {
     // Does any function need thread-local memory?
     bool needs_mem_;
 
+    // Segments of body that may be moved to separate translation units
+    std::vector<std::pair<std::streamoff, std::streamoff> > unit_segments_;
+    std::streamoff unit_start_;
+
+    // Names and declarations of the functions defined in such segments
+    std::vector<std::pair<std::string, std::string> > unit_functions_;
+
+    // Constants and function declarations of each file, the main file first
+    std::vector<std::string> file_constants_, file_declarations_;
+
+    // Additional translation units written by generate
+    std::vector<std::string> units_;
+
     // Hash a vector
     static size_t hash(const std::vector<double>& v);
     static size_t hash(const std::vector<casadi_int>& v);
@@ -24,6 +24,7 @@
 
 
 #include "finite_differences.hpp"
+#include "thread_pool.hpp"
 
 namespace casadi {
 
@@ -98,6 +99,10 @@ const Options FiniteDiff::options_
       {OT_INT,
       "Number of iterations to improve on the step-size "
       "[default: 1 if error estimate available, otherwise 0]"}},
+    {"parallelization",
+      {OT_STRING,
+      "Computational strategy for the directional derivatives: "
+      "serial|openmp|thread [default: serial]"}},
     }
 };
 
@@ -114,6 +119,7 @@ void FiniteDiff::init(const Dict& opts) {
   h_ = calc_stepsize(m_.abstol);
   u_aim_ = 100;
   h_iter_ = has_err() ? 1 : 0;
+  parallelization_ = "serial";
 
   // Read options
   for (auto&& op : opts) {
@@ -133,9 +139,37 @@ void FiniteDiff::init(const Dict& opts) {
       u_aim_ = op.second;
     } else if (op.first=="h_iter") {
       h_iter_ = op.second;
+    } else if (op.first=="parallelization") {
+      parallelization_ = op.second.to_string();
     }
   }
 
+  // Check parallelization strategy, fall back to serial if not compiled in
+  casadi_assert(parallelization_=="serial" || parallelization_=="openmp"
+    || parallelization_=="thread",
+    "Unknown parallelization '" + parallelization_ + "', "
+    "expected serial|openmp|thread");
+#ifndef WITH_OPENMP
+  if (parallelization_=="openmp") {
+    casadi_warning("CasADi was not compiled with WITH_OPENMP=ON. "
+                   "Falling back to serial evaluation.");
+    parallelization_ = "serial";
+  }
+#endif // WITH_OPENMP
+#ifndef CASADI_WITH_THREAD
+  if (parallelization_=="thread") {
+    casadi_warning("CasADi was not compiled with WITH_THREAD=ON. "
+                   "Falling back to serial evaluation.");
+    parallelization_ = "serial";
+  }
+#endif // CASADI_WITH_THREAD
+  if (parallelization_=="thread") {
+    // One copy per thread that may take part
+    n_copy_ = std::min(n_, ThreadPool::global().size());
+  } else {
+    n_copy_ = parallelization_=="serial" ? 1 : n_;
+  }
+
   // Check h_iter for consistency
   if (h_iter_!=0 && !has_err()) {
     casadi_error("Perturbation size refinement requires an error estimate, "
@@ -146,9 +180,9 @@ void FiniteDiff::init(const Dict& opts) {
   // Allocate work vector for (perturbed) inputs and outputs
   n_z_ = derivative_of_.nnz_in();
   n_y_ = derivative_of_.nnz_out();
-  alloc_res(n_pert(), true); // yk
-  alloc_w((n_pert() + 3) * n_y_, true); // yk[:], y0, y, J
-  alloc_w(n_z_, true); // z
+  alloc_w(n_y_, true); // y0
+  alloc_res(n_pert() * n_copy_, true); // yk, for each direction evaluated concurrently
+  alloc_w(((n_pert() + 2) * n_y_ + n_z_) * n_copy_, true); // J, yk[:], z, y
 
   // Dimensions
   if (verbose_) {
@@ -158,7 +192,20 @@ void FiniteDiff::init(const Dict& opts) {
   }
 
   // Allocate sufficient temporary memory for function evaluation
-  alloc(derivative_of_);
+  alloc(derivative_of_, false, n_copy_);
+}
+
+int FiniteDiff::init_mem(void* mem) const {
+  if (FunctionInternal::init_mem(mem)) return 1;
+  auto m = static_cast<FiniteDiffMemory*>(mem);
+  m->ret.resize(n_);
+  return 0;
+}
+
+void FiniteDiff::free_mem(void *mem) const {
+  auto m = static_cast<FiniteDiffMemory*>(mem);
+  for (int fm : m->f_mem) derivative_of_.release(fm);
+  delete m;
 }
 
 Sparsity FiniteDiff::get_sparsity_in(casadi_int i) {
@@ -235,6 +282,10 @@ int FiniteDiff::eval(const double** arg, double** res,
   casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
   casadi_int n_pert = this->n_pert();
 
+  // Work vector sizes of the differentiated function
+  size_t sz_arg, sz_res, sz_iw, sz_w;
+  derivative_of_.sz_work(sz_arg, sz_res, sz_iw, sz_w);
+
   // Non-differentiated input
   const double** x0 = arg;
   arg += n_in;
@@ -255,6 +306,87 @@ int FiniteDiff::eval(const double** arg, double** res,
   double** sens = res;
   res += n_out;
 
+  // Evaluate direction i using copy c of the work vectors
+  casadi_int sz_w_dir = (n_pert + 2) * n_y_ + n_z_;
+  double* w_f = w + n_copy_ * sz_w_dir;
+  auto dir = [&](casadi_int i, casadi_int c, int f_mem) {
+    return eval_dir(i, x0, y0, seed, sens, arg + c*sz_arg, res + c*(n_pert + sz_res),
+      iw + c*sz_iw, w + c*sz_w_dir, w_f + c*sz_w, f_mem);
+  };
+
+#ifdef WITH_OPENMP
+  if (parallelization_=="openmp") {
+    // Checkout memory objects
+    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_);
+    for (casadi_int i=0; i<n_; ++i) ind.emplace_back(derivative_of_);
+
+    // Error flag
+    casadi_int flag = 0;
+
+    // Evaluate in parallel
+#pragma omp parallel for reduction(||:flag)
+    for (casadi_int i=0; i<n_; ++i) {
+      try {
+        flag = dir(i, i, ind[i]) || flag;
+      } catch (std::exception& e) {
+        flag = 1;
+        casadi_warning("Exception raised: " + std::string(e.what()));
+      } catch (...) {
+        flag = 1;
+        casadi_warning("Uncaught exception.");
+      }
+    }
+    return flag;
+  }
+#endif // WITH_OPENMP
+
+#ifdef CASADI_WITH_THREAD
+  if (parallelization_=="thread") {
+    auto m = static_cast<FiniteDiffMemory*>(mem);
+    ThreadPool& pool = ThreadPool::global();
+
+    // Number of threads that may take part, each with its copy of the work vectors
+    casadi_int n_slot = std::min(n_copy_, pool.size());
+
+    // Each thread gets a memory object of the function, kept between calls
+    while (static_cast<casadi_int>(m->f_mem.size()) < n_slot) {
+      m->f_mem.push_back(derivative_of_.checkout());
+    }
+
+    // Evaluate
+    pool.run(n_, 1, n_slot, [&](casadi_int i, casadi_int slot) {
+      try {
+        m->ret[i] = dir(i, slot, m->f_mem[slot]);
+      } catch (std::exception& e) {
+        m->ret[i] = 1;
+        casadi_warning("Exception raised: " + std::string(e.what()));
+      } catch (...) {
+        m->ret[i] = 1;
+        casadi_warning("Uncaught exception.");
+      }
+    });
+
+    // Aggregate return value
+    for (int e : m->ret) if (e) return 1;
+    return 0;
+  }
+#endif // CASADI_WITH_THREAD
+
+  // For all sensitivity directions
+  scoped_checkout<Function> f_mem(derivative_of_);
+  for (casadi_int i=0; i<n_; ++i) {
+    if (dir(i, 0, f_mem)) return 1;
+  }
+  return 0;
+}
+
+int FiniteDiff::eval_dir(casadi_int i, const double** x0, double* y0,
+    const double** seed, double** sens, const double** arg, double** res,
+    casadi_int* iw, double* w, double* w_f, int f_mem) const {
+  // Shorthands
+  casadi_int n_in = derivative_of_.n_in(), n_out = derivative_of_.n_out();
+  casadi_int n_pert = this->n_pert();
+
   // Finite difference approximation
   double* J = w;
   w += n_y_;
@@ -280,50 +412,47 @@ int FiniteDiff::eval(const double** arg, double** res,
     w += derivative_of_.nnz_out(j);
   }
 
-  // For all sensitivity directions
-  for (casadi_int i=0; i<n_; ++i) {
-    // Initial stepsize
-    double h = h_;
-    // Perform finite difference algorithm with different step sizes
-    for (casadi_int iter=0; iter<1+h_iter_; ++iter) {
-      // Calculate perturbed function values
-      for (casadi_int k=0; k<n_pert; ++k) {
-        // Perturb inputs
-        casadi_int off = 0;
-        for (casadi_int j=0; j<n_in; ++j) {
-          casadi_int nnz = derivative_of_.nnz_in(j);
-          casadi_copy(x0[j], nnz, z + off);
-          if (seed[j]) casadi_axpy(nnz, pert(k, h), seed[j] + i*nnz, z + off);
-          off += nnz;
-        }
-        // Evaluate
-        if (derivative_of_(arg, res, iw, w)) return 1;
-        // Save outputs
-        casadi_copy(y, n_y_, yk[k]);
+  // Initial stepsize
+  double h = h_;
+  // Perform finite difference algorithm with different step sizes
+  for (casadi_int iter=0; iter<1+h_iter_; ++iter) {
+    // Calculate perturbed function values
+    for (casadi_int k=0; k<n_pert; ++k) {
+      // Perturb inputs
+      casadi_int off = 0;
+      for (casadi_int j=0; j<n_in; ++j) {
+        casadi_int nnz = derivative_of_.nnz_in(j);
+        casadi_copy(x0[j], nnz, z + off);
+        if (seed[j]) casadi_axpy(nnz, pert(k, h), seed[j] + i*nnz, z + off);
+        off += nnz;
       }
-      // Finite difference calculation with error estimate
-      double u = calc_fd(yk, y0, J, h);
-      if (iter==h_iter_) break;
-
-      // Update step size
-      if (u < 0) {
-        // Perturbation failed, try a smaller step size
-        h /= u_aim_;
-      } else {
-        // Update h to get u near the target ratio
-        h *= sqrt(u_aim_ / fmax(1., u));
-      }
-      // Make sure h stays in the range [h_min_,h_max_]
-      h = fmin(fmax(h, h_min_), h_max_);
+      // Evaluate
+      if (derivative_of_(arg, res, iw, w_f, f_mem)) return 1;
+      // Save outputs
+      casadi_copy(y, n_y_, yk[k]);
     }
-
-    // Gather sensitivities
-    casadi_int off = 0;
-    for (casadi_int j=0; j<n_out; ++j) {
-      casadi_int nnz = derivative_of_.nnz_out(j);
-      if (sens[j]) casadi_copy(J + off, nnz, sens[j] + i*nnz);
-      off += nnz;
+    // Finite difference calculation with error estimate
+    double u = calc_fd(yk, y0, J, h);
+    if (iter==h_iter_) break;
+
+    // Update step size
+    if (u < 0) {
+      // Perturbation failed, try a smaller step size
+      h /= u_aim_;
+    } else {
+      // Update h to get u near the target ratio
+      h *= sqrt(u_aim_ / fmax(1., u));
     }
+    // Make sure h stays in the range [h_min_,h_max_]
+    h = fmin(fmax(h, h_min_), h_max_);
+  }
+
+  // Gather sensitivities
+  casadi_int off = 0;
+  for (casadi_int j=0; j<n_out; ++j) {
+    casadi_int nnz = derivative_of_.nnz_out(j);
+    if (sens[j]) casadi_copy(J + off, nnz, sens[j] + i*nnz);
+    off += nnz;
   }
   return 0;
 }
@@ -61,6 +61,17 @@ CASADI_EXPORT void finite_diff(FdMode v, const T1** yk, T1* J, T1 h, casadi_int
   }
 }
 
+/** \brief Memory for parallel finite differences
+
+    Memory objects of the differentiated function, checked out once per thread
+*/
+struct CASADI_EXPORT FiniteDiffMemory : public FunctionMemory {
+  // Memory object of derivative_of_ for each slot of the thread pool
+  std::vector<int> f_mem;
+  // Return flag for each direction
+  std::vector<int> ret;
+};
+
 /** Calculate derivative using finite differences
   * \author Joel Andersson
   * \date 2017
@@ -117,9 +128,23 @@ public:
       \identifier{1ud} */
   void init(const Dict& opts) override;
 
+  /** \brief Create memory block */
+  void* alloc_mem() const override { return new FiniteDiffMemory();}
+
+  /** \brief Initalize memory block */
+  int init_mem(void* mem) const override;
+
+  /** \brief Free memory block */
+  void free_mem(void *mem) const override;
+
   // Evaluate numerically
   int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const override;
 
+  // Evaluate one directional derivative with its own work vectors
+  int eval_dir(casadi_int i, const double** x0, double* y0, const double** seed,
+    double** sens, const double** arg, double** res, casadi_int* iw, double* w,
+    double* w_f, int f_mem) const;
+
   /** \brief Is the scheme using the (nondifferentiated) output?
 
       \identifier{1ue} */
@@ -180,6 +205,13 @@ protected:
   // Allowed step size range
   double h_min_, h_max_;
 
+  // Computational strategy for the directional derivatives: serial|openmp|thread
+  std::string parallelization_;
+
+  // Number of copies of the work vectors: one if serial, one per thread
+  // of the pool if threaded, otherwise one per direction
+  casadi_int n_copy_;
+
   // Memory object
   casadi_finite_diff_mem<double> m_;
 };
@@ -1123,6 +1123,22 @@ namespace casadi {
     }
   }
 
+  Function Function::hvp(casadi_int nvec) const {
+    try {
+      return (*this)->hvp(nvec);
+    } catch(std::exception& e) {
+      THROW_ERROR("hvp", e.what());
+    }
+  }
+
+  Function Function::hessian(casadi_int iind) const {
+    try {
+      return (*this)->hessian(iind);
+    } catch(std::exception& e) {
+      THROW_ERROR("hessian", e.what());
+    }
+  }
+
   void Function::print_dimensions(std::ostream &stream) const {
     (*this)->print_dimensions(stream);
   }
@@ -1320,8 +1336,8 @@ namespace casadi {
     return deserialize(s);
   }
 
-  Function Function::load(const std::string& filename) {
-    FileDeserializer fs(filename);
+  Function Function::load(const std::string& filename, const Dict& opts) {
+    FileDeserializer fs(filename, opts);
     auto t = fs.pop_type();
     if (t==SerializerBase::SerializationType::SERIALIZED_FUNCTION) {
       return fs.blind_unpack_function();
@@ -1971,4 +1987,83 @@ namespace casadi {
     return f_.stats(mem_);
   }
 
+  FunctionContext::FunctionContext(const Function& f) : f_(f) {
+    casadi_assert(!f_.is_null(), "Cannot create context for null function");
+    w_.resize(f_.sz_w());
+    iw_.resize(f_.sz_iw());
+    arg_.resize(f_.sz_arg(), nullptr);
+    res_.resize(f_.sz_res(), nullptr);
+    n_in_ = f_.n_in();
+    n_out_ = f_.n_out();
+    mem_ = f_.checkout();
+  }
+
+  FunctionContext::~FunctionContext() {
+    if (mem_>=0) f_.release(mem_);
+  }
+
+  FunctionContext::FunctionContext(FunctionContext&& other) :
+      f_(other.f_), w_(std::move(other.w_)), iw_(std::move(other.iw_)),
+      arg_(std::move(other.arg_)), res_(std::move(other.res_)),
+      n_in_(other.n_in_), n_out_(other.n_out_), mem_(other.mem_) {
+    other.mem_ = -1;
+  }
+
+  // Contexts of the calling thread, least recently used first
+  static std::vector<std::unique_ptr<FunctionContext> >& local_contexts() {
+    static thread_local std::vector<std::unique_ptr<FunctionContext> > contexts;
+    return contexts;
+  }
+
+  FunctionContext& FunctionContext::local(const Function& f) {
+    auto& contexts = local_contexts();
+    for (auto it = contexts.begin(); it != contexts.end(); ++it) {
+      if ((*it)->f_.get()==f.get()) {
+        // Mark as most recently used
+        std::rotate(it, it + 1, contexts.end());
+        return *contexts.back();
+      }
+    }
+    // Drop contexts of functions that are no longer referenced elsewhere
+    contexts.erase(std::remove_if(contexts.begin(), contexts.end(),
+      [](const std::unique_ptr<FunctionContext>& c) { return c->f_.getCount()==1;}),
+      contexts.end());
+    // Drop the least recently used context if full
+    if (contexts.size() >= local_capacity) contexts.erase(contexts.begin());
+    contexts.emplace_back(new FunctionContext(f));
+    return *contexts.back();
+  }
+
+  void FunctionContext::clear_local() {
+    local_contexts().clear();
+  }
+
+  void FunctionContext::set_arg(casadi_int i, const double* a, casadi_int size) {
+    casadi_assert(size>=f_.nnz_in(i)*sizeof(double),
+     "Buffer is not large enough. Needed " + str(f_.nnz_in(i)*sizeof(double)) +
+     " bytes, got " + str(size) + ".");
+    arg_.at(i) = a;
+  }
+
+  void FunctionContext::set_res(casadi_int i, double* a, casadi_int size) {
+    casadi_assert(size>=f_.nnz_out(i)*sizeof(double),
+     "Buffer is not large enough. Needed " + str(f_.nnz_out(i)*sizeof(double)) +
+     " bytes, got " + str(size) + ".");
+    res_.at(i) = a;
+  }
+
+  int FunctionContext::eval() {
+    return f_(get_ptr(arg_), get_ptr(res_), get_ptr(iw_), get_ptr(w_), mem_);
+  }
+
+  int FunctionContext::eval(const double* const* arg, double* const* res) {
+    std::copy_n(arg, n_in_, arg_.begin());
+    std::copy_n(res, n_out_, res_.begin());
+    return eval();
+  }
+
+  Dict FunctionContext::stats() const {
+    return f_.stats(mem_);
+  }
+
 } // namespace casadi
@@ -819,6 +819,44 @@ namespace casadi {
         \identifier{1wr} */
     Function reverse(casadi_int nadj) const;
 
+    /** \brief Get a function that calculates \a nvec Hessian-vector products
+     *
+     *         Returns a function with <tt>n_in + n_out + n_in</tt> inputs
+     *         and <tt>n_in</tt> outputs.
+     *         The first <tt>n_in</tt> inputs correspond to nondifferentiated inputs.
+     *         The next <tt>n_out</tt> inputs are the weights of the outputs,
+     *         and the last <tt>n_in</tt> inputs are the vectors, stacked horizontally.
+     *         The <tt>n_in</tt> outputs are the products of the Hessian of the
+     *         weighted sum of the outputs with the vectors, stacked horizontally.
+     *
+     *        Calculated forward-over-reverse, without forming the Hessian or
+     *        its sparsity pattern.
+     *
+     *        The functions returned are cached, meaning that if called multiple timed
+     *        with the same value, then multiple references to the same function will be returned.
+
+        \identifier{29k} */
+    Function hvp(casadi_int nvec) const;
+
+    /** \brief Get a function that calculates the Hessian of the weighted outputs
+     *
+     *         Returns a function with <tt>n_in + n_out</tt> inputs and one output.
+     *         The first <tt>n_in</tt> inputs correspond to nondifferentiated inputs.
+     *         The next <tt>n_out</tt> inputs are the weights of the outputs.
+     *         The output is the Hessian of the weighted sum of the outputs
+     *         with respect to input \a iind.
+     *
+     *        For SX functions, the Hessian is calculated by edge pushing, a
+     *        single reverse sweep that gives both the sparsity pattern and
+     *        the nonzeros. Otherwise, the reverse mode gradient is
+     *        differentiated using star coloring.
+     *
+     *        The functions returned are cached, meaning that if called multiple timed
+     *        with the same value, then multiple references to the same function will be returned.
+
+        \identifier{29l} */
+    Function hessian(casadi_int iind=0) const;
+
     /** \brief Get, if necessary generate, the sparsity of all Jacobian blocks
 
         \identifier{1ws} */
@@ -894,6 +932,10 @@ namespace casadi {
 
     /** \brief Save Function to a file
 
+        Options: "debug" adds type information for checking during loading,
+        "binary" writes raw bytes instead of a printable character stream,
+        giving smaller files that load faster. Both kinds load with load().
+
         \see load
 
         \identifier{240} */
@@ -1177,8 +1219,10 @@ namespace casadi {
 
     /** \brief Build function from serialization
 
+        Options are passed to FileDeserializer, e.g. "mmap"
+
         \identifier{1y1} */
-    static Function load(const std::string& filename);
+    static Function load(const std::string& filename, const Dict& opts=Dict());
 
     /** \brief Build function from serialization
 
@@ -1339,6 +1383,122 @@ public:
 
 void CASADI_EXPORT _function_buffer_eval(void* raw);
 
+/** \brief Reusable context for repeated numeric evaluation
+
+    Owns work vectors sized for the function and a checked out memory
+    object, so that repeated calls with caller-owned input and output
+    buffers perform no heap allocations.
+
+    A context must not be used by several threads at the same time. Create
+    one context per thread, or use FunctionContext::local.
+
+    \code
+      FunctionContext ctx(f);
+      for (;;) {
+        ctx.eval(arg, res);  // arg, res: n_in/n_out pointers, null allowed
+      }
+    \endcode
+
+    \identifier{29m} */
+class CASADI_EXPORT FunctionContext {
+public:
+  /** \brief Create a context for a function
+
+      \identifier{29n} */
+  explicit FunctionContext(const Function& f);
+
+  /** \brief Release the memory object
+
+      \identifier{29t} */
+  ~FunctionContext();
+
+#ifndef SWIG
+  /// Movable, not copyable
+  FunctionContext(FunctionContext&& other);
+  FunctionContext(const FunctionContext&) = delete;
+  FunctionContext& operator=(const FunctionContext&) = delete;
+#endif // SWIG
+
+  /** \brief Context of the calling thread for a function
+
+      Created on first use and kept in a per-thread cache of at most
+      local_capacity contexts. A context is dropped from the cache when the
+      capacity is exceeded (least recently used first), when its function is
+      no longer referenced outside the cache, or by clear_local. The returned
+      reference is invalidated when the context is dropped.
+
+      \identifier{29o} */
+  static FunctionContext& local(const Function& f);
+
+  /** \brief Drop all contexts of the calling thread created by local
+
+      \identifier{29p} */
+  static void clear_local();
+
+  /// Maximum number of contexts per thread kept by local
+  static const casadi_int local_capacity = 16;
+
+  /// Function being evaluated
+  const Function& function() const { return f_;}
+
+#ifndef SWIG
+  /** \brief Set the buffer for input i, null for all zero
+
+      \identifier{29u} */
+  void set_arg(casadi_int i, const double* a) { arg_.at(i) = a;}
+
+  /** \brief Set the buffer for output i, null if not needed
+
+      \identifier{29v} */
+  void set_res(casadi_int i, double* r) { res_.at(i) = r;}
+#endif // SWIG
+
+  /** \brief Set the buffer for input i, checking its size in bytes
+
+      ctx.set_arg(0, memoryview(a))
+
+      Note that CasADi uses 'fortran' order: column-by-column
+
+      \identifier{29q} */
+  void set_arg(casadi_int i, const double* a, casadi_int size);
+
+  /** \brief Set the buffer for output i, checking its size in bytes
+
+      ctx.set_res(0, memoryview(a))
+
+      Note that CasADi uses 'fortran' order: column-by-column
+
+      \identifier{29r} */
+  void set_res(casadi_int i, double* a, casadi_int size);
+
+  /** \brief Evaluate with the buffers set by set_arg/set_res
+
+      \identifier{29s} */
+  int eval();
+
+#ifndef SWIG
+  /** \brief Evaluate with n_in input and n_out output buffers
+
+      Buffers hold the nonzeros, column-by-column. Null entries
+      stand for all zero inputs or unneeded outputs.
+
+      \identifier{29w} */
+  int eval(const double* const* arg, double* const* res);
+#endif // SWIG
+
+  /// Statistics of the last evaluation
+  Dict stats() const;
+
+private:
+  Function f_;
+  std::vector<double> w_;
+  std::vector<casadi_int> iw_;
+  std::vector<const double*> arg_;
+  std::vector<double*> res_;
+  casadi_int n_in_, n_out_;
+  int mem_;
+};
+
 
 } // namespace casadi
 
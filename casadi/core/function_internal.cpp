@@ -30,9 +30,13 @@
 #include "global_options.hpp"
 #include "external.hpp"
 #include "finite_differences.hpp"
+#include "jit_cache.hpp"
+#include "sparsity_database.hpp"
+#include "thread_pool.hpp"
 #include "serializing_stream.hpp"
 #include "mx_function.hpp"
 #include "sx_function.hpp"
+#include "sx_tape.hpp"
 #include "rootfinder_impl.hpp"
 #include "map.hpp"
 #include "mapsum.hpp"
@@ -87,6 +91,8 @@ namespace casadi {
     jit_serialize_ = "source";
     jit_base_name_ = "jit_tmp";
     jit_temp_suffix_ = true;
+    jit_cache_size_ = 0;
+    jit_unit_size_ = 0;
     compiler_plugin_ = CASADI_STR(CASADI_DEFAULT_COMPILER_PLUGIN);
 
     eval_ = nullptr;
@@ -129,6 +135,9 @@ namespace casadi {
       std::string jit_directory = get_from_dict(jit_options_, "directory", std::string(""));
       std::string jit_name = jit_directory + jit_name_ + ".c";
       if (remove(jit_name.c_str())) casadi_warning("Failed to remove " + jit_name);
+      for (const std::string& u : jit_units_) {
+        if (remove(u.c_str())) casadi_warning("Failed to remove " + u);
+      }
     }
   }
 
@@ -249,6 +258,20 @@ namespace casadi {
         "This is desired for thread-safety. "
         "This behaviour may defeat caching compiler wrappers. "
         "Default: true"}},
+      {"jit_cache_directory",
+       {OT_STRING,
+        "Directory of a persistent cache of compiled libraries, shared across processes. "
+        "Libraries are looked up by a hash of the generated code, compiler and options. "
+        "Default: '' (no cache)"}},
+      {"jit_cache_size",
+       {OT_INT,
+        "Bound on the total size in bytes of the libraries in 'jit_cache_directory'. "
+        "Least recently used entries are removed first. Default: 0 (no bound)"}},
+      {"jit_unit_size",
+       {OT_INT,
+        "Split the generated code into translation units of roughly this many lines, "
+        "compiled concurrently (see the 'jobs' option of the shell compiler). "
+        "Requires the shell compiler. Default: 0 (single file)"}},
       {"compiler",
        {OT_STRING,
         "Just-in-time compiler plugin to be used."}},
@@ -389,6 +412,9 @@ namespace casadi {
     opts["jit_options"] = jit_options_;
     opts["jit_name"] = jit_base_name_;
     opts["jit_temp_suffix"] = jit_temp_suffix_;
+    opts["jit_cache_directory"] = jit_cache_directory_;
+    opts["jit_cache_size"] = jit_cache_size_;
+    opts["jit_unit_size"] = jit_unit_size_;
     opts["ad_weight"] = ad_weight_;
     opts["ad_weight_sp"] = ad_weight_sp_;
     opts["always_inline"] = always_inline_;
@@ -481,6 +507,13 @@ namespace casadi {
         jit_base_name_ = op.second.to_string();
       } else if (op.first=="jit_temp_suffix") {
         jit_temp_suffix_ = op.second;
+      } else if (op.first=="jit_cache_directory") {
+        jit_cache_directory_ = op.second.to_string();
+      } else if (op.first=="jit_cache_size") {
+        jit_cache_size_ = op.second;
+      } else if (op.first=="jit_unit_size") {
+        jit_unit_size_ = op.second;
+        casadi_assert(jit_unit_size_>=0, "Option 'jit_unit_size' must be nonnegative");
       } else if (op.first=="derivative_of") {
         derivative_of_ = op.second;
       } else if (op.first=="ad_weight") {
@@ -695,11 +728,26 @@ namespace casadi {
           Dict opts;
           // Override the default to avoid random strings in the generated code
           opts["prefix"] = "jit";
+          if (jit_unit_size_>0) {
+            casadi_assert(compiler_plugin_=="shell",
+              "Option 'jit_unit_size' requires the shell compiler");
+            opts["unit_size"] = jit_unit_size_;
+          }
           CodeGenerator gen(jit_name_, opts);
           gen.add(self());
           if (verbose_) casadi_message("Compiling function '" + name_ + "'..");
           std::string jit_directory = get_from_dict(jit_options_, "directory", std::string(""));
-          compiler_ = Importer(gen.generate(jit_directory), compiler_plugin_, jit_options_);
+          std::string src = gen.generate(jit_directory);
+          // Additional translation units
+          Dict jit_options = jit_options_;
+          jit_units_ = gen.units();
+          if (!jit_units_.empty()) jit_options["extra_sources"] = jit_units_;
+          if (jit_cache_directory_.empty()) {
+            compiler_ = Importer(src, compiler_plugin_, jit_options);
+          } else {
+            JitCache cache(jit_cache_directory_, jit_cache_size_);
+            compiler_ = cache.compile(src, compiler_plugin_, jit_options, verbose_);
+          }
           if (verbose_) casadi_message("Compiling function '" + name_ + "' done.");
         }
         // Try to load
@@ -989,7 +1037,31 @@ namespace casadi {
 
   bool FunctionInternal::incache(const std::string& fname, Function& f,
       const std::string& suffix) const {
-    return cache_.incache(fname + ":" + suffix, f);
+    if (cache_.incache(fname + ":" + suffix, f)) return true;
+    // Entries of a deserialized cache_init_ are only created when needed
+    if (!suffix.empty()) return false;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::lock_guard<std::mutex> lock(cache_serialized_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    if (cache_serialized_.empty()) return false;
+    auto it = cache_serialized_.find(fname);
+    if (it == cache_serialized_.end()) return false;
+    if (it->second.second.is_null()) {
+      SerializedDataStream ss(it->second.first);
+      DeserializingStream ds(ss, it->second.first);
+      Function g = Function::deserialize(ds);
+      // Same check as for cache_init_ in init
+      if (fname != g.name()) {
+        casadi_warning("Cannot add '" + fname + "' a.k.a. '" + g.name()
+          + "' to cache. Mismatching names not implemented.");
+        cache_serialized_.erase(it);
+        return false;
+      }
+      it->second.second = g;
+      tocache_if_missing(it->second.second);
+    }
+    f = it->second.second;
+    return true;
   }
 
   void FunctionInternal::tocache(const Function& f, const std::string& suffix) const {
@@ -1108,6 +1180,11 @@ namespace casadi {
         if (!f->is_diff_out_[i] && res[i]) casadi_clear(res[i], f->nnz_out(i));
       }
     }
+    static inline void sp_wide(const FunctionInternal *f,
+                               const bvec_t** arg, bvec_t** res,
+                               casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) {
+      f->sp_forward_wide(arg, res, iw, w, mem, nw);
+    }
   };
   template<> struct JacSparsityTraits<false> {
     typedef bvec_t* arg_t;
@@ -1122,6 +1199,21 @@ namespace casadi {
         if (!f->is_diff_in_[i] && arg[i]) casadi_clear(arg[i], f->nnz_in(i));
       }
     }
+    static inline void sp_wide(const FunctionInternal *f,
+                               bvec_t** arg, bvec_t** res,
+                               casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) {
+      f->sp_reverse_wide(arg, res, iw, w, mem, nw);
+    }
+  };
+
+  // Buffers of one thread taking part in the sparsity sweeps
+  template<bool fwd> struct JacSparsityWork {
+    std::vector<typename JacSparsityTraits<fwd>::arg_t> arg;
+    std::vector<bvec_t*> res;
+    std::vector<casadi_int> iw;
+    std::vector<bvec_t> w, seed, sens;
+    // Triplets found by this thread
+    std::vector<casadi_int> jcol, jrow;
   };
 
   template<bool fwd>
@@ -1130,40 +1222,68 @@ namespace casadi {
     casadi_int nz_in = nnz_in(iind);
     casadi_int nz_out = nnz_out(oind);
 
-    // Evaluation buffers
-    std::vector<typename JacSparsityTraits<fwd>::arg_t> arg(sz_arg(), nullptr);
-    std::vector<bvec_t*> res(sz_res(), nullptr);
-    std::vector<casadi_int> iw(sz_iw());
-    std::vector<bvec_t> w(sz_w(), 0);
+    // No dependency through non-differentiable inputs or outputs
+    if (!is_diff_in_[iind] || !is_diff_out_[oind]) return Sparsity(nz_out, nz_in);
 
-    // Seeds and sensitivities
-    std::vector<bvec_t> seed(nz_in, 0);
-    arg[iind] = get_ptr(seed);
-    std::vector<bvec_t> sens(nz_out, 0);
-    res[oind] = get_ptr(sens);
-    if (!fwd) std::swap(seed, sens);
+    // Number of seed directions
+    casadi_int ndir = fwd ? nz_in : nz_out;
 
-    // Number of forward sweeps we must make
-    casadi_int nsweep = seed.size() / bvec_size;
-    if (seed.size() % bvec_size) nsweep++;
+    // Propagate several words of directions per sweep, if supported
+    casadi_int nw = 1;
+    if (has_sp_wide()) {
+      nw = std::min(GlobalOptions::sparsity_width / bvec_size, (ndir + bvec_size - 1) / bvec_size);
+      nw = std::max(nw, casadi_int(1));
+    }
+
+    // Number of sweeps we must make
+    casadi_int ndir_sweep = nw*bvec_size;
+    casadi_int nsweep = ndir / ndir_sweep;
+    if (ndir % ndir_sweep) nsweep++;
+
+    // Spread the sweeps over the thread pool, if supported
+    casadi_int n_slot = 1;
+    if (GlobalOptions::parallel_sparsity && nsweep > 1 && has_sp_parallel()) {
+      n_slot = std::min(nsweep, ThreadPool::global().size());
+    }
 
     // Print
     if (verbose_) {
       casadi_message(str(nsweep) + std::string(fwd ? " forward" : " reverse") + " sweeps "
-                     "needed for " + str(seed.size()) + " directions");
+                     "of width " + str(ndir_sweep) + " needed for " + str(ndir) + " directions"
+                     + (n_slot > 1 ? " on " + str(n_slot) + " threads" : ""));
     }
 
-    // Progress
-    casadi_int progress = -10;
+    // Buffers for each thread, allocated by the thread itself
+    std::vector< JacSparsityWork<fwd> > work(n_slot);
 
-    // Temporary vectors
-    std::vector<casadi_int> jcol, jrow;
+    // Memory object, not modified by sparsity propagation
+    void* mem = memory(0);
 
-    // Loop over the variables, bvec_size variables at a time
-    for (casadi_int s=0; s<nsweep; ++s) {
+    // Progress, only reported when serial
+    casadi_int progress = -10;
+
+    // Carry out one sweep
+    auto sweep = [&](casadi_int s, casadi_int slot) {
+      JacSparsityWork<fwd>& m = work[slot];
+
+      // Evaluation buffers
+      if (m.arg.empty()) {
+        m.arg.resize(sz_arg(), nullptr);
+        m.res.resize(sz_res(), nullptr);
+        m.iw.resize(sz_iw());
+        m.w.resize(nw==1 ? sz_w() : sz_w_sp_wide(nw), 0);
+        // Seeds and sensitivities, nw words per nonzero
+        m.seed.resize(nz_in*nw, 0);
+        m.sens.resize(nz_out*nw, 0);
+        m.arg[iind] = get_ptr(m.seed);
+        m.res[oind] = get_ptr(m.sens);
+        if (!fwd) std::swap(m.seed, m.sens);
+      }
+      std::vector<bvec_t>& seed = m.seed;
+      std::vector<bvec_t>& sens = m.sens;
 
       // Print progress
-      if (verbose_) {
+      if (verbose_ && n_slot==1) {
         casadi_int progress_new = (s*100)/nsweep;
         // Print when entering a new decade
         if (progress_new / 10 > progress / 10) {
@@ -1173,51 +1293,65 @@ namespace casadi {
       }
 
       // Nonzero offset
-      casadi_int offset = s*bvec_size;
+      casadi_int offset = s*ndir_sweep;
 
       // Number of local seed directions
-      casadi_int ndir_local = seed.size()-offset;
-      ndir_local = std::min(static_cast<casadi_int>(bvec_size), ndir_local);
+      casadi_int ndir_local = std::min(ndir_sweep, ndir-offset);
 
+      // Direction i is bit i%bvec_size of word i/bvec_size
       for (casadi_int i=0; i<ndir_local; ++i) {
-        seed[offset+i] |= bvec_t(1)<<i;
+        seed[(offset+i)*nw + i/bvec_size] |= bvec_t(1)<<(i%bvec_size);
       }
 
       // Propagate the dependencies
-      JacSparsityTraits<fwd>::sp(this, get_ptr(arg), get_ptr(res),
-                                  get_ptr(iw), get_ptr(w), memory(0));
+      if (nw==1) {
+        JacSparsityTraits<fwd>::sp(this, get_ptr(m.arg), get_ptr(m.res),
+                                    get_ptr(m.iw), get_ptr(m.w), mem);
+      } else {
+        JacSparsityTraits<fwd>::sp_wide(this, get_ptr(m.arg), get_ptr(m.res),
+                                         get_ptr(m.iw), get_ptr(m.w), mem, nw);
+      }
 
       // Loop over the nonzeros of the output
-      for (casadi_int el=0; el<sens.size(); ++el) {
+      for (casadi_int el=0; el<sens.size()/nw; ++el) {
+        for (casadi_int k=0; k<nw; ++k) {
+          // Get the sparsity sensitivity
+          bvec_t spsens = sens[el*nw+k];
 
-        // Get the sparsity sensitivity
-        bvec_t spsens = sens[el];
+          // If there is a dependency in any of the directions
+          if (spsens==0) continue;
 
-        if (!fwd) {
           // Clear the sensitivities for the next sweep
-          sens[el] = 0;
-        }
-
-        // If there is a dependency in any of the directions
-        if (spsens!=0) {
-
-          // Loop over seed directions
-          for (casadi_int i=0; i<ndir_local; ++i) {
+          if (!fwd) sens[el*nw+k] = 0;
 
+          // Loop over seed directions in the word
+          for (casadi_int i=0; i<bvec_size; ++i) {
             // If dependents on the variable
             if ((bvec_t(1) << i) & spsens) {
               // Add to pattern
-              jcol.push_back(el);
-              jrow.push_back(i+offset);
+              m.jcol.push_back(el);
+              m.jrow.push_back(offset+k*bvec_size+i);
             }
           }
         }
       }
 
       // Remove the seeds
-      for (casadi_int i=0; i<ndir_local; ++i) {
-        seed[offset+i] = 0;
-      }
+      std::fill(seed.begin() + offset*nw, seed.begin() + (offset+ndir_local)*nw, 0);
+    };
+
+    // Loop over the variables, ndir_sweep variables at a time
+    if (n_slot==1) {
+      for (casadi_int s=0; s<nsweep; ++s) sweep(s, 0);
+    } else {
+      ThreadPool::global().run(nsweep, 1, n_slot, sweep);
+    }
+
+    // Merge the triplets of all threads
+    std::vector<casadi_int> jcol, jrow;
+    for (auto&& m : work) {
+      jcol.insert(jcol.end(), m.jcol.begin(), m.jcol.end());
+      jrow.insert(jrow.end(), m.jrow.begin(), m.jrow.end());
     }
 
     // Construct sparsity pattern and return
@@ -1880,8 +2014,20 @@ namespace casadi {
           sp_is_compact = true;
         } else {
           // Use internal routine to determine sparsity
-          if (has_spfwd() || has_sprev() || has_jac_sparsity(oind, iind)) {
+          if (has_jac_sparsity(oind, iind)) {
             sp = get_jac_sparsity(oind, iind, symmetric);
+          } else if (has_spfwd() || has_sprev()) {
+            // Consult the persistent store before propagating
+            std::string key = sparsity_database_key("jac_sparsity " + str(oind) + " "
+              + str(iind) + " " + str(symmetric));
+            std::vector<Sparsity> stored;
+            if (!key.empty() && SparsityDatabase(GlobalOptions::sparsity_database).get(key, stored)
+                && stored.size()==1) {
+              sp = stored[0];
+            } else {
+              sp = get_jac_sparsity(oind, iind, symmetric);
+              if (!key.empty()) SparsityDatabase(GlobalOptions::sparsity_database).put(key, {sp});
+            }
           }
           // If null, dense
           if (sp.is_null()) sp = Sparsity::dense(nnz_out(oind), nnz_in(iind));
@@ -1915,12 +2061,56 @@ namespace casadi {
     return jsp;
   }
 
+  // Coloring with the fewest colors over several orderings, ties going to the first.
+  // Null if all orderings need more than cutoff colors.
+  static Sparsity coloring_best_of(const std::vector<casadi_int>& orderings, casadi_int cutoff,
+      const std::function<Sparsity(casadi_int ordering, casadi_int cutoff)>& color) {
+    casadi_int n = orderings.size();
+    std::vector<Sparsity> D(n);
+    bool parallel = false;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    // Try the orderings concurrently
+    ThreadPool& pool = ThreadPool::global();
+    parallel = pool.size() > 1;
+    if (parallel) {
+      pool.run(n, 1, std::min(n, pool.size()), [&](casadi_int k, casadi_int slot) {
+        D[k] = color(orderings[k], cutoff);
+      });
+    }
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    if (!parallel) {
+      // Try the orderings in turn, each must beat the previous ones
+      for (casadi_int k=0; k<n; ++k) {
+        D[k] = color(orderings[k], cutoff);
+        if (!D[k].is_null()) cutoff = D[k].size2()-1;
+      }
+    }
+    // Pick the best
+    Sparsity ret;
+    for (auto&& d : D) {
+      if (!d.is_null() && (ret.is_null() || d.size2() < ret.size2())) ret = d;
+    }
+    return ret;
+  }
+
   void FunctionInternal::get_partition(casadi_int iind, casadi_int oind, Sparsity& D1, Sparsity& D2,
                                        bool compact, bool symmetric,
                                        bool allow_forward, bool allow_reverse) const {
     if (verbose_) casadi_message(name_ + "::get_partition");
     casadi_assert(allow_forward || allow_reverse, "Inconsistent options");
 
+    // Consult the persistent store before coloring
+    std::string key = sparsity_database_key("partition " + str(iind) + " " + str(oind) + " "
+      + str(compact) + " " + str(symmetric) + " " + str(allow_forward) + " "
+      + str(allow_reverse) + " " + str(ad_weight()));
+    std::vector<Sparsity> stored;
+    if (!key.empty() && SparsityDatabase(GlobalOptions::sparsity_database).get(key, stored)
+        && stored.size()==2) {
+      D1 = stored[0];
+      D2 = stored[1];
+      return;
+    }
+
     // Sparsity pattern with transpose
     Sparsity &AT = jac_sparsity(oind, iind, compact, symmetric);
     Sparsity A = symmetric ? AT : AT.T();
@@ -1932,7 +2122,10 @@ namespace casadi {
 
       // Star coloring if symmetric
       if (verbose_) casadi_message("FunctionInternal::getPartition star_coloring");
-      D1 = A.star_coloring();
+      D1 = coloring_best_of({1, 2, 3}, std::numeric_limits<casadi_int>::max(),
+        [&A](casadi_int ordering, casadi_int cutoff) {
+          return A.star_coloring(ordering, cutoff);
+        });
       if (verbose_) {
         casadi_message("Star coloring completed: " + str(D1.size2())
           + " directional derivatives needed ("
@@ -1972,7 +2165,10 @@ namespace casadi {
           bool d = best_coloring>=w*static_cast<double>(A.size1());
           casadi_int max_colorings_to_test =
             d ? A.size1() : static_cast<casadi_int>(floor(best_coloring/w));
-          D1 = AT.uni_coloring(A, max_colorings_to_test);
+          D1 = coloring_best_of({0, 1, 2, 3}, max_colorings_to_test,
+            [&A, &AT](casadi_int ordering, casadi_int cutoff) {
+              return AT.uni_coloring(A, cutoff, ordering);
+            });
           if (D1.is_null()) {
             if (verbose_) {
               casadi_message("Forward mode coloring interrupted (more than "
@@ -1993,7 +2189,10 @@ namespace casadi {
           casadi_int max_colorings_to_test =
             d ? A.size2() : static_cast<casadi_int>(floor(best_coloring/(1-w)));
 
-          D2 = A.uni_coloring(AT, max_colorings_to_test);
+          D2 = coloring_best_of({0, 1, 2, 3}, max_colorings_to_test,
+            [&A, &AT](casadi_int ordering, casadi_int cutoff) {
+              return A.uni_coloring(AT, cutoff, ordering);
+            });
           if (D2.is_null()) {
             if (verbose_) {
               casadi_message("Adjoint mode coloring interrupted (more than "
@@ -2012,6 +2211,27 @@ namespace casadi {
       }
 
     }
+    if (!key.empty()) SparsityDatabase(GlobalOptions::sparsity_database).put(key, {D1, D2});
+  }
+
+  std::string FunctionInternal::sparsity_database_key(const std::string& block) const {
+    if (GlobalOptions::sparsity_database.empty()) return "";
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::lock_guard<std::mutex> lock(structure_key_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    // The serialized function without names identifies the structure,
+    // computed once per instance
+    if (!structure_key_) {
+      std::stringstream ss;
+      try {
+        self().serialize(ss, {{"binary", true}, {"names", false}});
+        structure_key_.reset(new std::string(ss.str()));
+      } catch (std::exception&) {
+        structure_key_.reset(new std::string());
+      }
+    }
+    if (structure_key_->empty()) return "";
+    return block + "\n" + *structure_key_;
   }
 
   std::vector<DM> FunctionInternal::eval_dm(const std::vector<DM>& arg) const {
@@ -2173,6 +2393,107 @@ namespace casadi {
     return f;
   }
 
+  Function FunctionInternal::hvp(casadi_int nvec) const {
+    casadi_assert_dev(nvec>=0);
+    casadi_assert(has_derivative(), "Derivatives cannot be calculated for " + name_);
+    // Retrieve/generate cached
+    Function f;
+    std::string fname = hvp_name(name_, nvec);
+    if (!incache(fname, f)) {
+      casadi_int i;
+      // Prefixes to be used for multipliers, directions and products
+      std::string pref_adj = diff_prefix("adj"), pref_fwd = diff_prefix("fwd");
+      std::string pref_hvp = diff_prefix("hvp");
+      // Symbolic inputs
+      std::vector<MX> arg = mx_in(), lam(n_out_), v(n_in_);
+      for (i=0; i<n_out_; ++i) lam[i] = MX::sym(pref_adj + name_out_[i], sparsity_out(i));
+      for (i=0; i<n_in_; ++i) {
+        v[i] = MX::sym(pref_fwd + name_in_[i], repmat(sparsity_in(i), 1, nvec));
+      }
+      // Gradient of the weighted outputs, reverse mode
+      std::vector<MX> res = self()(arg);
+      std::vector<MX> grad = MX::reverse(res, arg, {lam})[0];
+      // Directional derivatives of the gradient, all directions in one forward sweep
+      std::vector<std::vector<MX> > fseed(nvec, std::vector<MX>(n_in_));
+      for (i=0; i<n_in_; ++i) {
+        std::vector<MX> v_split = horzsplit(v[i], size2_in(i));
+        for (casadi_int d=0; d<nvec; ++d) fseed[d][i] = v_split[d];
+      }
+      std::vector<std::vector<MX> > fsens = MX::forward(grad, arg, fseed);
+      // Stack the products horizontally
+      std::vector<MX> ret(n_in_);
+      for (i=0; i<n_in_; ++i) {
+        std::vector<MX> hv(nvec);
+        for (casadi_int d=0; d<nvec; ++d) hv[d] = project(fsens[d][i], sparsity_in(i));
+        ret[i] = nvec==0 ? MX(size1_in(i), 0) : horzcat(hv);
+      }
+      // Names of inputs and outputs
+      std::vector<std::string> inames, onames;
+      for (i=0; i<n_in_; ++i) inames.push_back(name_in_[i]);
+      for (i=0; i<n_out_; ++i) inames.push_back(pref_adj + name_out_[i]);
+      for (i=0; i<n_in_; ++i) inames.push_back(pref_fwd + name_in_[i]);
+      for (i=0; i<n_in_; ++i) onames.push_back(pref_hvp + name_in_[i]);
+      // Assemble
+      arg.insert(arg.end(), lam.begin(), lam.end());
+      arg.insert(arg.end(), v.begin(), v.end());
+      Dict opts = der_options_;
+      opts["derivative_of"] = self();
+      f = Function(fname, arg, ret, inames, onames, opts);
+      // Save to cache
+      tocache_if_missing(f);
+    }
+    return f;
+  }
+
+  Function FunctionInternal::hessian(casadi_int iind) const {
+    casadi_assert(iind>=0 && iind<n_in_, "Input index out of bounds");
+    casadi_assert(has_derivative(), "Derivatives cannot be calculated for " + name_);
+    // Retrieve/generate cached
+    Function f;
+    std::string fname = hessian_name(name_, name_in_[iind]);
+    if (!incache(fname, f)) {
+      casadi_int i;
+      // Prefix to be used for the output weights
+      std::string pref = diff_prefix("adj");
+      // Names of inputs
+      std::vector<std::string> inames;
+      for (i=0; i<n_in_; ++i) inames.push_back(name_in_[i]);
+      for (i=0; i<n_out_; ++i) inames.push_back(pref + name_out_[i]);
+      // Names of outputs
+      std::vector<std::string> onames = {"hess_" + name_in_[iind]};
+      // Options
+      Dict opts = der_options_;
+      opts["derivative_of"] = self();
+      // Generate Hessian function
+      f = get_hessian(iind, fname, inames, onames, opts);
+      // Consistency check
+      casadi_assert_dev(f.n_in()==n_in_ + n_out_);
+      casadi_assert_dev(f.n_out()==1);
+      f.assert_size_out(0, numel_in(iind), numel_in(iind));
+      // Save to cache
+      tocache_if_missing(f);
+    }
+    return f;
+  }
+
+  Function FunctionInternal::
+  get_hessian(casadi_int iind, const std::string& name,
+              const std::vector<std::string>& inames,
+              const std::vector<std::string>& onames,
+              const Dict& opts) const {
+    // Symbolic inputs and output weights
+    std::vector<MX> arg = mx_in(), lam(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) lam[i] = MX::sym(inames[n_in_+i], sparsity_out(i));
+    // Reverse mode gradient of the weighted outputs
+    std::vector<MX> res = self()(arg);
+    MX grad = MX::reverse(res, arg, {lam})[0][iind];
+    // Symmetric Jacobian of the gradient
+    MX H = MX::jacobian(grad, arg[iind], {{"symmetric", true}});
+    // Assemble
+    arg.insert(arg.end(), lam.begin(), lam.end());
+    return Function(name, arg, {H}, inames, onames, opts);
+  }
+
   Function FunctionInternal::
   get_forward(casadi_int nfwd, const std::string& name,
               const std::vector<std::string>& inames,
@@ -2251,7 +2572,8 @@ namespace casadi {
       // Derivative information must be available
       casadi_assert(has_derivative(),
                             "Derivatives cannot be calculated for " + name_);
-      return wrap().jacobian();
+      // Finite differences can be compressed directly
+      if (!enable_fd_ || enable_reverse_) return wrap().jacobian();
     }
     // Retrieve/generate cached
     Function f;
@@ -2273,8 +2595,12 @@ namespace casadi {
       Dict opts = combine(jacobian_options_, der_options_);
       opts["derivative_of"] = self();
       // Generate derivative function
-      casadi_assert_dev(enable_jacobian_);
-      f = get_jacobian(fname, inames, onames, opts);
+      if (has_jacobian()) {
+        casadi_assert_dev(enable_jacobian_);
+        f = get_jacobian(fname, inames, onames, opts);
+      } else {
+        f = get_jacobian_fd(fname, inames, onames, opts);
+      }
       // Consistency checks
       casadi_assert(f.n_in() == inames.size(),
         "Mismatching input signature, expected " + str(inames));
@@ -2294,10 +2620,101 @@ namespace casadi {
     casadi_error("'get_jacobian' not defined for " + class_name());
   }
 
+  Function FunctionInternal::
+  get_jacobian_fd(const std::string& name,
+                  const std::vector<std::string>& inames,
+                  const std::vector<std::string>& onames,
+                  const Dict& opts) const {
+    casadi_assert_dev(enable_fd_);
+    // Offsets of the inputs in the stacked nonzeros
+    std::vector<casadi_int> offset_in(1, 0);
+    for (casadi_int i=0; i<n_in_; ++i) offset_in.push_back(offset_in.back() + nnz_in(i));
+    // Jacobian sparsity of all nonzero outputs with respect to all nonzero inputs
+    std::vector<std::vector<Sparsity> > blocks(n_out_, std::vector<Sparsity>(n_in_));
+    for (casadi_int oind=0; oind<n_out_; ++oind) {
+      for (casadi_int iind=0; iind<n_in_; ++iind) {
+        if (is_diff_out_[oind] && is_diff_in_[iind]) {
+          blocks[oind][iind] = jac_sparsity(oind, iind, true, false);
+        } else {
+          blocks[oind][iind] = Sparsity(nnz_out(oind), nnz_in(iind));
+        }
+      }
+    }
+    Sparsity J = blockcat(blocks);
+    Sparsity JT = J.T();
+    // Group the columns that can be perturbed together
+    Sparsity D = coloring_best_of({0, 1, 2, 3}, J.size2(),
+      [&J, &JT](casadi_int ordering, casadi_int cutoff) {
+        return J.uni_coloring(JT, cutoff, ordering);
+      });
+    casadi_int nfwd = D.size2();
+    if (verbose_) {
+      casadi_message("Compressed finite differences: " + str(nfwd)
+        + " directions needed (" + str(J.size2()) + " without coloring).");
+    }
+    std::vector<casadi_int> color(J.size2(), -1);
+    const casadi_int *D_colind = D.colind(), *D_row = D.row();
+    for (casadi_int c=0; c<nfwd; ++c) {
+      for (casadi_int k=D_colind[c]; k<D_colind[c+1]; ++k) color[D_row[k]] = c;
+    }
+    // Symbolic inputs
+    std::vector<MX> arg = mx_in(), out(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) out[i] = MX::sym("out_" + name_out_[i], sparsity_out(i));
+    // Compressed directional derivatives
+    std::vector<MX> sens;
+    if (nfwd > 0) {
+      std::vector<MX> fwd_arg = arg;
+      fwd_arg.insert(fwd_arg.end(), out.begin(), out.end());
+      for (casadi_int i=0; i<n_in_; ++i) {
+        // Seed for input i: unit entries for the columns of each color
+        std::vector<double> seed(nnz_in(i) * nfwd, 0);
+        for (casadi_int k=0; k<nnz_in(i); ++k) {
+          casadi_int c = color[offset_in[i] + k];
+          if (c >= 0) seed[c * nnz_in(i) + k] = 1;
+        }
+        fwd_arg.push_back(DM(repmat(sparsity_in(i), 1, nfwd), seed));
+      }
+      sens = forward(nfwd)(fwd_arg);
+    }
+    // Recover the Jacobian nonzeros
+    std::vector<MX> jac;
+    jac.reserve(n_out_ * n_in_);
+    for (casadi_int oind=0; oind<n_out_; ++oind) {
+      for (casadi_int iind=0; iind<n_in_; ++iind) {
+        const Sparsity& sp = blocks[oind][iind];
+        const casadi_int *colind = sp.colind(), *row = sp.row();
+        Sparsity sp_jac = is_diff_out_[oind] && is_diff_in_[iind]
+          ? jac_sparsity(oind, iind, false, false)
+          : Sparsity(numel_out(oind), numel_in(iind));
+        if (sp.nnz() == 0) {
+          jac.push_back(MX::zeros(sp_jac));
+          continue;
+        }
+        // Nonzero (r, c) is entry r of the directional derivative for the color of c
+        std::vector<casadi_int> nz;
+        nz.reserve(sp.nnz());
+        for (casadi_int c=0; c<sp.size2(); ++c) {
+          casadi_int k = color[offset_in[iind] + c] * nnz_out(oind);
+          for (casadi_int el=colind[c]; el<colind[c+1]; ++el) nz.push_back(k + row[el]);
+        }
+        MX v;
+        sens[oind].get_nz(v, false, IM(nz));
+        jac.push_back(sparsity_cast(v, sp_jac));
+      }
+    }
+    // Assemble
+    arg.insert(arg.end(), out.begin(), out.end());
+    return Function(name, arg, jac, inames, onames, opts);
+  }
+
   void FunctionInternal::codegen(CodeGenerator& g, const std::string& fname) const {
+    // Functions without thread-local memory may go to a separate translation unit
+    bool split = g.unit_size>0 && codegen_mem_type().empty() && !has_refcount_;
+    if (split) g.unit_begin();
+
     // Define function
     g << "/* " << definition() << " */\n";
-    g << "static " << signature(fname) << " {\n";
+    g << (split ? "" : "static ") << signature(fname) << " {\n";
 
     // Reset local variables, flush buffer
     g.flush(g.body);
@@ -2315,6 +2732,7 @@ namespace casadi {
 
     // Flush to function body
     g.flush(g.body);
+    if (split) g.unit_end(fname, signature(fname));
   }
 
   std::string FunctionInternal::signature(const std::string& fname) const {
@@ -2742,6 +3160,11 @@ namespace casadi {
     casadi_error("'generate_dependencies' not defined for " + class_name());
   }
 
+  int FunctionInternal::eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem, casadi_int n) const {
+    casadi_error("'eval_batch' not defined for " + class_name());
+  }
+
   int FunctionInternal::
   sp_forward(const bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const {
     // Loop over outputs
@@ -2777,6 +3200,16 @@ namespace casadi {
     return 0;
   }
 
+  int FunctionInternal::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    casadi_error("'sp_forward_wide' not defined for " + class_name());
+  }
+
+  int FunctionInternal::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    casadi_error("'sp_reverse_wide' not defined for " + class_name());
+  }
+
   int FunctionInternal::
   sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const {
     // Loop over outputs
@@ -3848,7 +4281,7 @@ namespace casadi {
 
   void ProtoFunction::serialize_body(SerializingStream& s) const {
     s.version("ProtoFunction", 2);
-    s.pack("ProtoFunction::name", name_);
+    s.pack("ProtoFunction::name", s.names() ? name_ : std::string());
     s.pack("ProtoFunction::verbose", verbose_);
     s.pack("ProtoFunction::print_time", print_time_);
     s.pack("ProtoFunction::record_time", record_time_);
@@ -3872,13 +4305,15 @@ namespace casadi {
 
   void FunctionInternal::serialize_body(SerializingStream& s) const {
     ProtoFunction::serialize_body(s);
-    s.version("FunctionInternal", 6);
+    s.version("FunctionInternal", 9);
     s.pack("FunctionInternal::is_diff_in", is_diff_in_);
     s.pack("FunctionInternal::is_diff_out", is_diff_out_);
     s.pack("FunctionInternal::sp_in", sparsity_in_);
     s.pack("FunctionInternal::sp_out", sparsity_out_);
-    s.pack("FunctionInternal::name_in", name_in_);
-    s.pack("FunctionInternal::name_out", name_out_);
+    s.pack("FunctionInternal::name_in",
+      s.names() ? name_in_ : std::vector<std::string>(name_in_.size()));
+    s.pack("FunctionInternal::name_out",
+      s.names() ? name_out_ : std::vector<std::string>(name_out_.size()));
 
     s.pack("FunctionInternal::jit", jit_);
     s.pack("FunctionInternal::jit_cleanup", jit_cleanup_);
@@ -3894,10 +4329,27 @@ namespace casadi {
     s.pack("FunctionInternal::jit_temp_suffix", jit_temp_suffix_);
     s.pack("FunctionInternal::jit_base_name", jit_base_name_);
     s.pack("FunctionInternal::jit_options", jit_options_);
+    s.pack("FunctionInternal::jit_cache_directory", jit_cache_directory_);
+    s.pack("FunctionInternal::jit_cache_size", jit_cache_size_);
+    s.pack("FunctionInternal::jit_unit_size", jit_unit_size_);
     s.pack("FunctionInternal::compiler_plugin", compiler_plugin_);
     s.pack("FunctionInternal::has_refcount", has_refcount_);
 
-    s.pack("FunctionInternal::cache_init", cache_init_);
+    // Cache entries are stored as independent (binary) streams so that they
+    // can be deserialized on demand
+    std::map<std::string, SerializedData> cache_init;
+    for (auto&& c : cache_init_) {
+      std::stringstream ss;
+      {
+        SerializingStream s2(ss, {{"binary", true}, {"debug", s.debug()}, {"names", s.names()}});
+        c.second.as_function().serialize(s2);
+      }
+      cache_init[c.first] = SerializedData(ss.str());
+    }
+    for (auto&& c : cache_serialized_) {
+      if (cache_init.find(c.first) == cache_init.end()) cache_init[c.first] = c.second.first;
+    }
+    s.pack("FunctionInternal::cache_init", cache_init);
 
     s.pack("FunctionInternal::derivative_of", derivative_of_);
 
@@ -3948,7 +4400,7 @@ namespace casadi {
   }
 
   FunctionInternal::FunctionInternal(DeserializingStream& s) : ProtoFunction(s) {
-    int version = s.version("FunctionInternal", 1, 6);
+    int version = s.version("FunctionInternal", 1, 9);
     s.unpack("FunctionInternal::is_diff_in", is_diff_in_);
     s.unpack("FunctionInternal::is_diff_out", is_diff_out_);
     s.unpack("FunctionInternal::sp_in", sparsity_in_);
@@ -3983,10 +4435,25 @@ namespace casadi {
     s.unpack("FunctionInternal::jit_temp_suffix", jit_temp_suffix_);
     s.unpack("FunctionInternal::jit_base_name", jit_base_name_);
     s.unpack("FunctionInternal::jit_options", jit_options_);
+    if (version >= 8) {
+      s.unpack("FunctionInternal::jit_cache_directory", jit_cache_directory_);
+      s.unpack("FunctionInternal::jit_cache_size", jit_cache_size_);
+    } else {
+      jit_cache_size_ = 0;
+    }
+    if (version >= 9) {
+      s.unpack("FunctionInternal::jit_unit_size", jit_unit_size_);
+    } else {
+      jit_unit_size_ = 0;
+    }
     s.unpack("FunctionInternal::compiler_plugin", compiler_plugin_);
     s.unpack("FunctionInternal::has_refcount", has_refcount_);
 
-    if (version >= 6) {
+    if (version >= 7) {
+      std::map<std::string, SerializedData> cache_init;
+      s.unpack("FunctionInternal::cache_init", cache_init);
+      for (auto&& c : cache_init) cache_serialized_[c.first].first = c.second;
+    } else if (version >= 6) {
       s.unpack("FunctionInternal::cache_init", cache_init_);
     }
 
@@ -4083,6 +4550,7 @@ namespace casadi {
       FunctionInternal::deserialize_map = {
     {"MXFunction", MXFunction::deserialize},
     {"SXFunction", SXFunction::deserialize},
+    {"SXTape", SXTape::deserialize},
     {"Interpolant", Interpolant::deserialize},
     {"Switch", Switch::deserialize},
     {"Map", Map::deserialize},
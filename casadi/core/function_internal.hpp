@@ -33,6 +33,7 @@
 #include "importer.hpp"
 #include "options.hpp"
 #include "shared_object_internal.hpp"
+#include "serializing_stream.hpp"
 #include "timing.hpp"
 #ifdef CASADI_WITH_THREAD
 #ifdef CASADI_WITH_THREAD_MINGW
@@ -380,6 +381,19 @@ namespace casadi {
     virtual int eval(const double** arg, double** res, casadi_int* iw, double* w, void* mem) const;
     ///@}
 
+    /** \brief Evaluate numerically at n points simultaneously
+
+        Inputs and outputs of consecutive points are stored consecutively, as
+        for Map. The real work vector must have length sz_w_batch(). */
+    virtual int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem, casadi_int n) const;
+
+    /// Is eval_batch supported?
+    virtual bool has_eval_batch() const { return false;}
+
+    /// Length of the real work vector needed by eval_batch
+    virtual size_t sz_w_batch() const { return 0;}
+
     /** \brief  Evaluate with symbolic scalars
 
         \identifier{kc} */
@@ -600,6 +614,16 @@ namespace casadi {
                                   const Dict& opts) const;
     ///@}
 
+    /** \brief Jacobian by compressed finite differences
+
+        Columns that do not share a row in the Jacobian sparsity pattern are
+        perturbed together (Curtis-Powell-Reid), after which the nonzeros are
+        recovered from the compressed directional derivatives. */
+    Function get_jacobian_fd(const std::string& name,
+                             const std::vector<std::string>& inames,
+                             const std::vector<std::string>& onames,
+                             const Dict& opts) const;
+
     ///@{
     /** \brief Get Jacobian sparsity
 
@@ -610,6 +634,11 @@ namespace casadi {
     virtual Sparsity get_jac_sparsity(casadi_int oind, casadi_int iind, bool symmetric) const;
     ///@}
 
+    /** \brief Key of a block in the persistent sparsity database
+
+        Empty if no database is set or the function cannot be serialized. */
+    std::string sparsity_database_key(const std::string& block) const;
+
     /// Helper function: Get name of forward derivative function
     static std::string forward_name(const std::string& fcn, casadi_int nfwd) {
       return "fwd" + str(nfwd) + "_" + fcn;
@@ -655,6 +684,36 @@ namespace casadi {
                                  const Dict& opts) const;
     ///@}
 
+    /// Helper function: Get name of Hessian-vector product function
+    static std::string hvp_name(const std::string& fcn, casadi_int nvec) {
+      return "hvp" + str(nvec) + "_" + fcn;
+    }
+
+    /** \brief Return function that calculates Hessian-vector products
+
+        Forward-over-reverse: a forward sweep with \a nvec directions through
+        the reverse mode derivative. The Hessian is never formed. */
+    Function hvp(casadi_int nvec) const;
+
+    /// Helper function: Get name of Hessian function
+    static std::string hessian_name(const std::string& fcn, const std::string& iname) {
+      return "hess_" + iname + "_" + fcn;
+    }
+
+    ///@{
+    /** \brief Return function that calculates the Hessian of the weighted outputs
+
+     *    hessian(iind) returns a cached instance if available,
+     *    and calls <tt>Function get_hessian(casadi_int iind)</tt>
+     *    if no cached version is available. By default, the Hessian is the
+     *    Jacobian of the reverse mode gradient, using star coloring. */
+    Function hessian(casadi_int iind) const;
+    virtual Function get_hessian(casadi_int iind, const std::string& name,
+                                 const std::vector<std::string>& inames,
+                                 const std::vector<std::string>& onames,
+                                 const Dict& opts) const;
+    ///@}
+
     /** \brief Ensure that a matrix's sparsity is a horizontal multiple of another, or empty
 
         \identifier{26j} */
@@ -1137,6 +1196,28 @@ namespace casadi {
         \identifier{my} */
     virtual int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const;
 
+    /** \brief Is sparsity propagation over several words per nonzero supported?
+
+        Propagates nw*bvec_size directions in a single sweep. */
+    virtual bool has_sp_wide() const { return false;}
+
+    /** \brief Can sparsity propagation run concurrently?
+
+        Requires that sp_forward/sp_reverse (and their wide variants) only
+        modify the buffers passed to them. */
+    virtual bool has_sp_parallel() const { return false;}
+
+    /** \brief Get required length of w field for wide sparsity propagation */
+    virtual size_t sz_w_sp_wide(casadi_int nw) const { return sz_w()*nw;}
+
+    /** \brief  Propagate sparsity forward, nw consecutive words per nonzero */
+    virtual int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const;
+
+    /** \brief  Propagate sparsity backwards, nw consecutive words per nonzero */
+    virtual int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const;
+
     /** \brief Get number of temporary variables needed
 
         \identifier{mz} */
@@ -1277,6 +1358,18 @@ namespace casadi {
         \identifier{nj} */
     bool jit_temp_suffix_;
 
+    /// Persistent cache of compiled libraries, empty if none
+    std::string jit_cache_directory_;
+
+    /// Bound on the size of the persistent cache in bytes, zero if none
+    casadi_int jit_cache_size_;
+
+    /// Approximate number of lines per generated translation unit, zero for one file
+    casadi_int jit_unit_size_;
+
+    /// Additional generated translation units
+    std::vector<std::string> jit_units_;
+
     /** \brief Numerical evaluation redirected to a C function
 
         \identifier{nk} */
@@ -1310,6 +1403,16 @@ namespace casadi {
     /// Function cache
     mutable WeakCache<std::string, Function> cache_;
 
+    /** \brief Deserialized cache_init_ entries, materialized on first use
+
+        Each entry is a self-contained serialization and the Function, once created */
+    mutable std::map<std::string, std::pair<SerializedData, Function> > cache_serialized_;
+
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    /// Mutex for thread safety
+    mutable std::mutex cache_serialized_mtx_;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
     /// Cache for sparsities of the Jacobian blocks
     mutable std::vector<Sparsity> jac_sparsity_[2];
 
@@ -1318,6 +1421,14 @@ namespace casadi {
     mutable std::mutex jac_sparsity_mtx_;
 #endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
+    /// Serialized structure for sparsity_database_key, computed on first use
+    mutable std::unique_ptr<std::string> structure_key_;
+
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    /// Mutex for thread safety
+    mutable std::mutex structure_key_mtx_;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
     /// If the function is the derivative of another function
     Function derivative_of_;
 
@@ -25,11 +25,13 @@
 
 #include "global_options.hpp"
 #include "exception.hpp"
+#include "thread_pool.hpp"
 
 namespace casadi {
 
   bool GlobalOptions::simplification_on_the_fly = true;
   bool GlobalOptions::hierarchical_sparsity = true;
+  bool GlobalOptions::parallel_sparsity = true;
 
   std::string GlobalOptions::casadipath;
   std::string GlobalOptions::casadi_include_path;
@@ -44,4 +46,21 @@ namespace casadi {
 
   casadi_int GlobalOptions::copy_elision_min_size = 8;
 
+  casadi_int GlobalOptions::thread_pool_size = 0;
+
+  void GlobalOptions::setThreadPoolSize(casadi_int n) {
+    casadi_assert(n>=0, "Thread pool size must be nonnegative");
+    thread_pool_size = n;
+    ThreadPool::global().resize(n);
+  }
+
+  std::string GlobalOptions::sparsity_database;
+
+  casadi_int GlobalOptions::sparsity_width = 256;
+
+  void GlobalOptions::setSparsityWidth(casadi_int n) {
+    casadi_assert(n>0, "Sparsity width must be positive");
+    sparsity_width = bvec_size*((n+bvec_size-1)/bvec_size);
+  }
+
 } // namespace casadi
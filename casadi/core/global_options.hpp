@@ -66,6 +66,8 @@ namespace casadi {
 
       static bool hierarchical_sparsity;
 
+      static bool parallel_sparsity;
+
       static casadi_int max_num_dir;
 
       static casadi_int start_index;
@@ -74,6 +76,12 @@ namespace casadi {
 
       static casadi_int copy_elision_min_size;
 
+      static casadi_int thread_pool_size;
+
+      static casadi_int sparsity_width;
+
+      static std::string sparsity_database;
+
 #endif //SWIG
       // Setter and getter for simplification_on_the_fly
       static void setSimplificationOnTheFly(bool flag) { simplification_on_the_fly = flag; }
@@ -83,6 +91,14 @@ namespace casadi {
       static void setHierarchicalSparsity(bool flag) { hierarchical_sparsity = flag; }
       static bool getHierarchicalSparsity() { return hierarchical_sparsity; }
 
+      /** \brief Spread Jacobian sparsity sweeps over the thread pool
+
+      * Only for functions that support concurrent sparsity propagation.
+      * Default: true
+      */
+      static void setParallelSparsity(bool flag) { parallel_sparsity = flag; }
+      static bool getParallelSparsity() { return parallel_sparsity; }
+
       static void setCasadiPath(const std::string & path) { casadipath = path; }
       static std::string getCasadiPath() { return casadipath; }
 
@@ -100,6 +116,32 @@ namespace casadi {
       }
       static casadi_int getCopyElisionMinSize() { return copy_elision_min_size; }
 
+      /** \brief Number of threads in the pool used for parallel evaluation
+
+      * Counts the calling thread. Zero means one per hardware thread.
+      * Default: 0
+      */
+      static void setThreadPoolSize(casadi_int n);
+      static casadi_int getThreadPoolSize() { return thread_pool_size; }
+
+      /** \brief Number of directions per sparsity propagation sweep
+
+      * Rounded up to a multiple of 64. Functions that cannot propagate
+      * wider blocks use 64.
+      * Default: 256
+      */
+      static void setSparsityWidth(casadi_int n);
+      static casadi_int getSparsityWidth() { return sparsity_width; }
+
+      /** \brief Directory of a persistent store of Jacobian sparsity patterns
+
+      * Patterns and colorings are looked up by the serialized function before
+      * propagating sparsity, and shared across processes.
+      * Default: '' (no store)
+      */
+      static void setSparsityDatabase(const std::string& dir) { sparsity_database = dir; }
+      static std::string getSparsityDatabase() { return sparsity_database; }
+
   };
 
 } // namespace casadi
@@ -0,0 +1,254 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "jit_cache.hpp"
+#include "casadi_misc.hpp"
+#include "casadi_meta.hpp"
+#include "casadi_os.hpp"
+#include <casadi/config.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#include <io.h>
+#include <sys/utime.h>
+#else // _WIN32
+#include <dirent.h>
+#include <utime.h>
+#endif // _WIN32
+
+// Set default shared library suffix
+#ifndef SHARED_LIBRARY_SUFFIX
+#define SHARED_LIBRARY_SUFFIX CASADI_SHARED_LIBRARY_SUFFIX
+#endif // SHARED_LIBRARY_SUFFIX
+
+namespace casadi {
+
+  // File name prefix of all cache entries
+  static const char* jit_cache_prefix = "casadi_jit_";
+
+  // 64-bit FNV-1a hash, stable across platforms and runs
+  static std::string jit_cache_hash(const std::string& s) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : s) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    std::stringstream ss;
+    ss << std::hex;
+    ss.width(16);
+    ss.fill('0');
+    ss << h;
+    return ss.str();
+  }
+
+  // Read a file into a string, empty if it cannot be read
+  static bool jit_cache_read(const std::string& fname, std::string& content) {
+    std::ifstream f(fname, std::ios_base::binary);
+    if (!f.good()) return false;
+    std::stringstream ss;
+    ss << f.rdbuf();
+    content = ss.str();
+    return true;
+  }
+
+  // Copy a file
+  static bool jit_cache_copy(const std::string& from, const std::string& to) {
+    std::ifstream in(from, std::ios_base::binary);
+    std::ofstream out(to, std::ios_base::binary);
+    if (!in.good() || !out.good()) return false;
+    out << in.rdbuf();
+    return out.good();
+  }
+
+  // Mark a file as recently used
+  static void jit_cache_touch(const std::string& fname) {
+#ifdef _WIN32
+    _utime(fname.c_str(), nullptr);
+#else // _WIN32
+    utime(fname.c_str(), nullptr);
+#endif // _WIN32
+  }
+
+  // Cache entry on disk
+  struct JitCacheEntry {
+    std::string base;
+    time_t mtime;
+    casadi_int size;
+  };
+
+  // List cached libraries
+  static std::vector<JitCacheEntry> jit_cache_list(const std::string& directory) {
+    std::vector<JitCacheEntry> ret;
+    std::string prefix = jit_cache_prefix;
+    std::string suffix = SHARED_LIBRARY_SUFFIX;
+    std::vector<std::string> names;
+#ifdef _WIN32
+    struct _finddata_t d;
+    intptr_t h = _findfirst((directory + prefix + "*" + suffix).c_str(), &d);
+    if (h != -1) {
+      do {
+        names.push_back(d.name);
+      } while (_findnext(h, &d) == 0);
+      _findclose(h);
+    }
+#else // _WIN32
+    DIR* dir = opendir(directory.c_str());
+    if (dir) {
+      while (struct dirent* d = readdir(dir)) {
+        names.push_back(d->d_name);
+      }
+      closedir(dir);
+    }
+#endif // _WIN32
+    for (const std::string& n : names) {
+      if (n.size() <= prefix.size() + suffix.size()) continue;
+      if (n.compare(0, prefix.size(), prefix) != 0) continue;
+      if (n.compare(n.size() - suffix.size(), suffix.size(), suffix) != 0) continue;
+      struct stat st;
+      std::string lib = directory + n;
+      if (stat(lib.c_str(), &st) != 0) continue;
+      JitCacheEntry e;
+      e.base = directory + n.substr(0, n.size() - suffix.size());
+      e.mtime = st.st_mtime;
+      e.size = st.st_size;
+      ret.push_back(e);
+    }
+    return ret;
+  }
+
+  JitCache::JitCache(const std::string& directory, casadi_int max_size)
+      : directory_(directory), max_size_(max_size) {
+    casadi_assert(!directory_.empty(), "JIT cache directory must be nonempty");
+    casadi_assert(max_size_ >= 0, "JIT cache size bound must be nonnegative");
+    char last = directory_.back();
+    if (last != '/' && last != '\\') directory_ += filesep();
+    // Create directory, failure is detected when writing
+#ifdef _WIN32
+    _mkdir(directory_.c_str());
+#else // _WIN32
+    mkdir(directory_.c_str(), 0755);
+#endif // _WIN32
+  }
+
+  Importer JitCache::compile(const std::string& src_file, const std::string& plugin,
+      const Dict& opts, bool verbose) const {
+    // Generated source
+    std::string src;
+    casadi_assert(jit_cache_read(src_file, src), "Cannot read '" + src_file + "'.");
+
+    // Additional sources enter by contents, their names may be temporary
+    Dict key_opts = opts;
+    auto it = key_opts.find("extra_sources");
+    if (it!=key_opts.end()) {
+      std::vector<std::string> extra = it->second.to_string_vector();
+      for (std::string& e : extra) {
+        std::string fname = e;
+        casadi_assert(jit_cache_read(fname, e), "Cannot read '" + fname + "'.");
+      }
+      it->second = extra;
+    }
+
+    // Everything that affects the compiled library
+    std::stringstream key;
+    key << CasadiMeta::version() << "\n" << plugin << "\n" << key_opts << "\n" << src;
+    std::string base = directory_ + jit_cache_prefix + jit_cache_hash(key.str());
+    std::string lib = base + SHARED_LIBRARY_SUFFIX;
+    std::string key_file = base + ".key";
+
+    // Cache hit if the stored key matches exactly
+    std::string stored;
+    if (jit_cache_read(key_file, stored) && stored == key.str()) {
+      std::ifstream lib_exists(lib);
+      if (lib_exists.good()) {
+        if (verbose) casadi_message("JIT cache hit: '" + lib + "'.");
+        jit_cache_touch(lib);
+        return Importer(lib, "dll");
+      }
+    }
+
+    // Compile
+    if (verbose) casadi_message("JIT cache miss: '" + lib + "'.");
+    Importer compiler(src_file, plugin, opts);
+
+    // Only compilers that produce a shared library can be cached
+    std::string compiled;
+    try {
+      compiled = compiler.library();
+    } catch (std::exception&) {
+      return compiler;
+    }
+
+    // Add to cache, renaming makes the entry appear atomically
+    std::string tmp = temporary_file(base, SHARED_LIBRARY_SUFFIX);
+    if (jit_cache_copy(compiled, tmp) && std::rename(tmp.c_str(), lib.c_str()) == 0) {
+      // Likewise for the key, so that readers never see a truncated one
+      std::string tmp_key = temporary_file(base, ".key");
+      bool written;
+      {
+        std::ofstream k(tmp_key, std::ios_base::binary);
+        k << key.str();
+        written = k.good();
+      }
+      if (!written || std::rename(tmp_key.c_str(), key_file.c_str()) != 0) {
+        std::remove(tmp_key.c_str());
+        if (verbose) casadi_message("Could not write the JIT cache key '" + key_file + "'.");
+      }
+    } else {
+      std::remove(tmp.c_str());
+      if (verbose) casadi_message("Could not add '" + lib + "' to JIT cache.");
+    }
+
+    // Enforce size bound
+    if (max_size_ > 0) evict();
+    return compiler;
+  }
+
+  void JitCache::evict() const {
+    std::vector<JitCacheEntry> entries = jit_cache_list(directory_);
+    casadi_int total = 0;
+    for (auto&& e : entries) total += e.size;
+    if (total <= max_size_) return;
+    // Oldest first
+    std::sort(entries.begin(), entries.end(),
+      [](const JitCacheEntry& a, const JitCacheEntry& b) { return a.mtime < b.mtime;});
+    for (auto&& e : entries) {
+      if (total <= max_size_) break;
+      std::string lib = e.base + SHARED_LIBRARY_SUFFIX;
+      std::string key_file = e.base + ".key";
+      // Libraries in use cannot be removed on some platforms
+      if (std::remove(lib.c_str()) == 0) {
+        std::remove(key_file.c_str());
+        total -= e.size;
+      }
+    }
+  }
+
+} // namespace casadi
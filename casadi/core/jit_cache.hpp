@@ -0,0 +1,77 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_JIT_CACHE_HPP
+#define CASADI_JIT_CACHE_HPP
+
+#include "importer.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Persistent on-disk cache of JIT compiled libraries
+
+      Libraries are stored under a hash of the generated source, the compiler
+      plugin, its options and the CasADi version. A hit loads the stored library
+      without invoking the compiler. The full key is stored alongside the library
+      and compared on a hit to guard against hash collisions.
+
+      When the total size of the cached libraries exceeds a bound, the least
+      recently used entries are removed.
+  */
+  class CASADI_EXPORT JitCache {
+  public:
+    /** \brief Constructor
+
+        \param directory  Location of the cache, created if missing
+        \param max_size   Bound on the total size in bytes, zero for no bound
+    */
+    JitCache(const std::string& directory, casadi_int max_size);
+
+    /** \brief Load from cache or compile and add to cache
+
+        \param src_file   Generated C source
+        \param plugin     Compiler plugin, e.g. "shell"
+        \param opts       Options for the compiler plugin
+    */
+    Importer compile(const std::string& src_file, const std::string& plugin,
+      const Dict& opts, bool verbose=false) const;
+
+  private:
+    // Remove least recently used entries until within the size bound
+    void evict() const;
+
+    // Directory, ending with a file separator
+    std::string directory_;
+
+    // Bound on the total size, zero for no bound
+    casadi_int max_size_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_JIT_CACHE_HPP
@@ -24,6 +24,7 @@
 
 
 #include "linsol_internal.hpp"
+#include "thread_pool.hpp"
 
 namespace casadi {
 
@@ -60,6 +61,102 @@ namespace casadi {
     return 0;
   }
 
+  void LinsolInternal::level_schedule(const std::vector<casadi_int>& level,
+      std::vector<casadi_int>& ptr, std::vector<casadi_int>& ind) {
+    // Counting sort by level
+    casadi_int n_level = 0;
+    for (casadi_int l : level) n_level = std::max(n_level, l + 1);
+    ptr.assign(n_level + 1, 0);
+    for (casadi_int l : level) ptr[l + 1]++;
+    for (casadi_int l=0; l<n_level; ++l) ptr[l + 1] += ptr[l];
+    ind.resize(level.size());
+    std::vector<casadi_int> next(ptr.begin(), ptr.end() - 1);
+    for (casadi_int i=0; i<level.size(); ++i) ind[next[level[i]]++] = i;
+  }
+
+  void LinsolInternal::run_levels(const std::vector<casadi_int>& ptr,
+      const std::vector<casadi_int>& ind, casadi_int n_slot,
+      const std::function<void(casadi_int, casadi_int)>& f) {
+    for (casadi_int l=0; l+1<ptr.size(); ++l) {
+      const casadi_int* tasks = get_ptr(ind) + ptr[l];
+      casadi_int n_task = ptr[l + 1] - ptr[l];
+      if (n_task==1 || n_slot<=1) {
+        // Nothing to gain from the thread pool
+        for (casadi_int t=0; t<n_task; ++t) f(tasks[t], 0);
+      } else {
+        // Chunks large enough to amortize the scheduling
+        casadi_int chunk = std::max(n_task / (4 * n_slot), casadi_int(1));
+        ThreadPool::global().run(n_task, chunk, n_slot, [&](casadi_int t, casadi_int slot) {
+          f(tasks[t], slot);
+        });
+      }
+    }
+  }
+
+  casadi_int LinsolInternal::max_slots() {
+    return ThreadPool::global().size();
+  }
+
+  // Analyses by key and sparsity hash, each entry held as long as a solver uses it
+  typedef std::map<std::pair<std::string, std::size_t>,
+    std::vector<std::pair<Sparsity, std::weak_ptr<void> > > > SharedSymbolicCache;
+
+  // Look up a live analysis of a pattern in the cache
+  static std::shared_ptr<void> shared_symbolic_find(const SharedSymbolicCache& cache,
+      const std::pair<std::string, std::size_t>& k, const Sparsity& sp) {
+    auto b = cache.find(k);
+    if (b == cache.end()) return nullptr;
+    for (auto&& e : b->second) {
+      if (e.first.is_equal(sp)) {
+        std::shared_ptr<void> ret = e.second.lock();
+        if (ret) return ret;
+      }
+    }
+    return nullptr;
+  }
+
+  // Drop expired entries, releasing their patterns, and empty buckets
+  static void shared_symbolic_sweep(SharedSymbolicCache& cache) {
+    for (auto b = cache.begin(); b != cache.end(); ) {
+      auto& v = b->second;
+      v.erase(std::remove_if(v.begin(), v.end(),
+        [](const std::pair<Sparsity, std::weak_ptr<void> >& e) {
+          return e.second.expired();}), v.end());
+      if (v.empty()) {
+        b = cache.erase(b);
+      } else {
+        ++b;
+      }
+    }
+  }
+
+  std::shared_ptr<void> LinsolInternal::shared_symbolic_void(const std::string& key,
+      const std::function<std::shared_ptr<void>()>& create) const {
+    static SharedSymbolicCache cache;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    static std::mutex mtx;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    auto k = std::make_pair(key, sp_.hash());
+    {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::lock_guard<std::mutex> lock(mtx);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+      std::shared_ptr<void> ret = shared_symbolic_find(cache, k, sp_);
+      if (ret) return ret;
+    }
+    // Perform the analysis without holding the lock
+    std::shared_ptr<void> ret = create();
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::lock_guard<std::mutex> lock(mtx);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    // Another thread may have stored an analysis in the meantime
+    std::shared_ptr<void> other = shared_symbolic_find(cache, k, sp_);
+    if (other) return other;
+    shared_symbolic_sweep(cache);
+    cache[k].push_back(std::make_pair(sp_, std::weak_ptr<void>(ret)));
+    return ret;
+  }
+
   void LinsolInternal::linsol_eval_sx(const SXElem** arg, SXElem** res, casadi_int* iw, SXElem* w,
                                       void* mem, bool tr, casadi_int nrhs) const {
     casadi_error("eval_sx not defined for " + class_name());
@@ -120,6 +217,8 @@ namespace casadi {
 
   const std::string LinsolInternal::infix_ = "linsol";
 
+  const casadi_int LinsolInternal::rhs_block_;
+
 
   void LinsolInternal::serialize_type(SerializingStream &s) const {
     ProtoFunction::serialize_type(s);
@@ -29,6 +29,7 @@
 #include "linsol.hpp"
 #include "function_internal.hpp"
 #include "plugin_interface.hpp"
+#include <functional>
 
 /// \cond INTERNAL
 
@@ -117,6 +118,9 @@ namespace casadi {
     virtual void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                           casadi_int nrhs, bool tr) const;
 
+    /// Length of the work vector w used by the generated code
+    virtual size_t generate_sz_w() const { return 0;}
+
     // Creator function for internal class
     typedef LinsolInternal* (*Creator)(const std::string& name, const Sparsity& sp);
 
@@ -143,6 +147,46 @@ namespace casadi {
     const casadi_int* row() const { return sp_.row();}
     casadi_int nnz() const { return sp_.nnz();}
 
+    /** \brief Group mutually independent tasks of a factorization
+
+        A task may only depend on tasks with a lower level, e.g. its
+        descendants in the elimination tree. On return, the tasks of
+        level l are ind[ptr[l]], ..., ind[ptr[l+1]-1]. */
+    static void level_schedule(const std::vector<casadi_int>& level,
+                               std::vector<casadi_int>& ptr, std::vector<casadi_int>& ind);
+
+    /** \brief Execute f(task, slot) level by level
+
+        Tasks within a level are distributed over at most n_slot threads
+        of the global thread pool. */
+    static void run_levels(const std::vector<casadi_int>& ptr, const std::vector<casadi_int>& ind,
+                           casadi_int n_slot,
+                           const std::function<void(casadi_int, casadi_int)>& f);
+
+    /// Number of threads available for a parallel factorization
+    static casadi_int max_slots();
+
+    /// Number of right-hand sides processed together by the blocked solves
+    static const casadi_int rhs_block_ = 8;
+
+    /** \brief Symbolic analysis of sp_, shared between linear solvers
+
+        Returns the analysis stored under key, e.g. the plugin name and the
+        options it depends on, for the sparsity pattern of the solver.
+        If there is none, it is created with create(). Solvers with the same
+        pattern, including copies created by Function::map, thus perform the
+        analysis only once. An analysis is released with its last user. */
+    template<typename T>
+    std::shared_ptr<T> shared_symbolic(const std::string& key,
+                                       const std::function<std::shared_ptr<T>()>& create) const {
+      return std::static_pointer_cast<T>(shared_symbolic_void(key,
+        [&]() -> std::shared_ptr<void> { return create(); }));
+    }
+
+    /// Type-erased shared_symbolic
+    std::shared_ptr<void> shared_symbolic_void(const std::string& key,
+      const std::function<std::shared_ptr<void>()>& create) const;
+
     /** \brief Serialize type information
 
         \identifier{e9} */
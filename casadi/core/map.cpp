@@ -25,14 +25,7 @@
 
 #include "map.hpp"
 #include "serializing_stream.hpp"
-
-#ifdef CASADI_WITH_THREAD
-#ifdef CASADI_WITH_THREAD_MINGW
-#include <mingw.thread.h>
-#else // CASADI_WITH_THREAD_MINGW
-#include <thread>
-#endif // CASADI_WITH_THREAD_MINGW
-#endif // CASADI_WITH_THREAD
+#include "thread_pool.hpp"
 
 namespace casadi {
 
@@ -51,7 +44,7 @@ namespace casadi {
   }
 
   Map::Map(const std::string& name, const Function& f, casadi_int n)
-    : FunctionInternal(name), f_(f), n_(n) {
+    : FunctionInternal(name), f_(f), n_(n), batch_(false) {
   }
 
   bool Map::is_a(const std::string& type, bool recursive) const {
@@ -88,6 +81,8 @@ namespace casadi {
     FunctionInternal::serialize_body(s);
     s.pack("Map::f", f_);
     s.pack("Map::n", n_);
+    s.version("Map", 1);
+    s.pack("Map::batch", batch_);
   }
 
   void Map::serialize_type(SerializingStream &s) const {
@@ -98,6 +93,13 @@ namespace casadi {
   Map::Map(DeserializingStream& s) : FunctionInternal(s) {
     s.unpack("Map::f", f_);
     s.unpack("Map::n", n_);
+    if (s.protocol() >= 5) {
+      s.version("Map", 1);
+      s.unpack("Map::batch", batch_);
+    } else {
+      // Work vector of older streams is only large enough without batching
+      batch_ = false;
+    }
   }
 
   ProtoFunction* Map::deserialize(DeserializingStream& s) {
@@ -129,6 +131,10 @@ namespace casadi {
     alloc_res(f_.sz_res());
     alloc_w(f_.sz_w());
     alloc_iw(f_.sz_iw());
+
+    // Evaluate all points at once, if supported
+    batch_ = f_->has_eval_batch();
+    if (batch_) alloc_w(f_->sz_w_batch());
   }
 
   template<typename T>
@@ -320,6 +326,7 @@ namespace casadi {
     // Could also use the thread-safe variant f_(arg1, res1, iw, w)
     // in Map::eval_gen
     scoped_checkout<Function> m(f_);
+    if (batch_) return f_->eval_batch(arg, res, iw, w, f_.memory(m), n_);
     return eval_gen(arg, res, iw, w, m);
   }
 
@@ -458,41 +465,47 @@ namespace casadi {
     }
   }
 
+  int ThreadMap::init_mem(void* mem) const {
+    if (Map::init_mem(mem)) return 1;
+    auto m = static_cast<ThreadMapMemory*>(mem);
+    m->ret.resize(n_);
+    return 0;
+  }
+
+  void ThreadMap::free_mem(void *mem) const {
+    auto m = static_cast<ThreadMapMemory*>(mem);
+    for (int fm : m->f_mem) f_.release(fm);
+    delete m;
+  }
+
   int ThreadMap::eval(const double** arg, double** res, casadi_int* iw, double* w,
       void* mem) const {
 
 #ifndef CASADI_WITH_THREAD
     return Map::eval(arg, res, iw, w, mem);
 #else // CASADI_WITH_THREAD
-    // Checkout memory objects
-    std::vector< scoped_checkout<Function> > ind; ind.reserve(n_);
-    for (casadi_int i=0; i<n_; ++i) ind.emplace_back(f_);
+    auto m = static_cast<ThreadMapMemory*>(mem);
+    ThreadPool& pool = ThreadPool::global();
 
-    // Allocate space for return values
-    std::vector<int> ret_values(n_);
+    // Number of threads that may take part
+    casadi_int n_slot = std::min(n_, pool.size());
 
-    // Spawn threads
-    std::vector<std::thread> threads;
-    for (casadi_int i=0; i<n_; ++i) {
-      // Why the lambda function?
-      // Because it was the first iteration to pass tests on MingGW
-      // using mingw-std-threads.
-      threads.emplace_back(
-        [i](const Function& f, const double** arg, double** res,
-            casadi_int* iw, double* w, casadi_int ind, int& ret) {
-              ThreadsWork(f, i, arg, res, iw, w, ind, ret);
-            },
-        std::ref(f_), arg, res, iw, w, casadi_int(ind[i]), std::ref(ret_values[i]));
-    }
+    // Each thread gets a memory object of f, kept between calls
+    while (static_cast<casadi_int>(m->f_mem.size()) < n_slot) m->f_mem.push_back(f_.checkout());
 
-    // Join threads
-    for (auto && th : threads) th.join();
+    // Assign several evaluations at a time to limit contention
+    casadi_int chunk_size = std::max(n_ / (4 * n_slot), casadi_int(1));
+
+    // Evaluate
+    pool.run(n_, chunk_size, n_slot, [&](casadi_int i, casadi_int slot) {
+      ThreadsWork(f_, i, arg, res, iw, w, m->f_mem[slot], m->ret[i]);
+    });
 
     // Anticipate success
     int ret = 0;
 
     // Compute aggregate return value
-    for (int e : ret_values) ret = ret || e;
+    for (int e : m->ret) ret = ret || e;
 
     return ret;
 #endif // CASADI_WITH_THREAD
@@ -510,9 +523,6 @@ namespace casadi {
     // Call the initialization method of the base class
     Map::init(opts);
 
-    // Allocate memory for holding memory object references
-    alloc_iw(n_, true);
-
     // Allocate sufficient memory for parallel evaluation
     alloc_arg(f_.sz_arg() * n_);
     alloc_res(f_.sz_res() * n_);
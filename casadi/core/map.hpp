@@ -213,6 +213,9 @@ namespace casadi {
 
     // Number of times to evaluate this function
     casadi_int n_;
+
+    // Evaluate all points at once with FunctionInternal::eval_batch
+    bool batch_;
   };
 
   /** A map Evaluate in parallel using OpenMP
@@ -266,7 +269,19 @@ namespace casadi {
     explicit OmpMap(DeserializingStream& s) : Map(s) {}
   };
 
+  /** \brief Memory for ThreadMap
+
+      Memory objects of the mapped function, checked out once per thread
+  */
+  struct CASADI_EXPORT ThreadMapMemory : public FunctionMemory {
+    // Memory object of f for each slot of the thread pool
+    std::vector<int> f_mem;
+    // Return flag for each evaluation
+    std::vector<int> ret;
+  };
+
   /** A map Evaluate in parallel using std::thread
+      Evaluations are distributed in chunks over the persistent ThreadPool.
       Note: Do not use this class with much more than the intended number of
       threads for the parallel evaluation as it will cause excessive memory use.
 
@@ -305,6 +320,15 @@ namespace casadi {
     /// Type of parallellization
     std::string parallelization() const override { return "thread"; }
 
+    /** \brief Create memory block */
+    void* alloc_mem() const override { return new ThreadMapMemory();}
+
+    /** \brief Initalize memory block */
+    int init_mem(void* mem) const override;
+
+    /** \brief Free memory block */
+    void free_mem(void *mem) const override;
+
     /** \brief Generate code for the body of the C function
 
         \identifier{hy} */
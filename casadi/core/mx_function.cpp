@@ -107,6 +107,14 @@ namespace casadi {
     }
   }
 
+  std::vector<MXNode*> MXFunction::symbolic_nodes(const MX& x) {
+    std::vector<MXNode*> ret;
+    for (auto&& p : x.primitives()) {
+      if (p.is_symbolic()) ret.push_back(p.get());
+    }
+    return ret;
+  }
+
   void MXFunction::init(const Dict& opts) {
     // Call the init function of the base class
     XFunction<MXFunction, MX, MXNode>::init(opts);
@@ -155,9 +163,9 @@ namespace casadi {
 
     // All nodes
     std::vector<MXNode*> nodes;
-#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
-    std::lock_guard<std::mutex> lock(MX::get_mutex_temp());
-#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
+    // Place of each node in the sorted graph, local to this function
+    NodeMap<MXNode> node_index;
 
     // Add the list of nodes
     for (casadi_int ind=0; ind<out_.size(); ++ind) {
@@ -167,7 +175,7 @@ namespace casadi {
       for (casadi_int p=0; p<prim.size(); ++p) {
         // Get the nodes using a depth first search
         s.push(prim[p].get());
-        sort_depth_first(s, nodes);
+        sort_depth_first(s, nodes, node_index);
         // Add an output instruction ("data" below will take ownership)
         nodes.push_back(new Output(prim[p], ind, p, nz_offset));
         // Update offset
@@ -177,7 +185,7 @@ namespace casadi {
 
     // Set the temporary variables to be the corresponding place in the sorted graph
     for (casadi_int i=0; i<nodes.size(); ++i) {
-      nodes[i]->temp = i;
+      node_index[nodes[i]] = i;
     }
 
     // Place in the algorithm for each node
@@ -210,13 +218,13 @@ namespace casadi {
         ae.data.own(n);
         ae.arg.resize(n->n_dep());
         for (casadi_int i=0; i<n->n_dep(); ++i) {
-          ae.arg[i] = n->dep(i)->temp;
+          ae.arg[i] = node_index.get(n->dep(i).get());
         }
         ae.res.resize(n->nout());
         if (n->has_output()) {
           std::fill(ae.res.begin(), ae.res.end(), -1);
         } else if (!ae.res.empty()) {
-          ae.res[0] = n->temp;
+          ae.res[0] = node_index.get(n);
         }
 
         // Increase the reference count of the dependencies
@@ -235,14 +243,16 @@ namespace casadi {
         casadi_int oind = n->which_output();
 
         // Get the index of the parent node
-        casadi_int pind = place_in_alg[n->dep(0)->temp];
+        casadi_int pind = place_in_alg[node_index.get(n->dep(0).get())];
 
         // Save location in the algorithm element corresponding to the parent node
         casadi_int& otmp = algorithm_[pind].res.at(oind);
         if (otmp<0) {
-          otmp = n->temp; // First time this function output is encountered, save to algorithm
+          // First time this function output is encountered, save to algorithm
+          otmp = node_index.get(n);
         } else {
-          n->temp = otmp; // Function output is a duplicate, use the node encountered first
+          // Function output is a duplicate, use the node encountered first
+          node_index[n] = otmp;
         }
 
         // Not in the algorithm
@@ -368,16 +378,10 @@ namespace casadi {
     sz_w += wind;
     alloc_w(sz_w);
 
-    // Reset the temporary variables
-    for (casadi_int i=0; i<nodes.size(); ++i) {
-      if (nodes[i]) {
-        nodes[i]->temp = 0;
-      }
-    }
-
     // Now mark each input's place in the algorithm
+    NodeMap<MXNode> input_loc(symb_loc.size());
     for (auto it=symb_loc.begin(); it!=symb_loc.end(); ++it) {
-      it->second->temp = it->first+1;
+      input_loc[it->second] = it->first+1;
     }
 
     // Add input instructions, loop over inputs
@@ -386,10 +390,11 @@ namespace casadi {
       std::vector<MX> prim = in_[ind].primitives();
       casadi_int nz_offset=0;
       for (casadi_int p=0; p<prim.size(); ++p) {
-        casadi_int i = prim[p].get_temp()-1;
+        casadi_int& loc = input_loc[prim[p].get()];
+        casadi_int i = loc-1;
         if (i>=0) {
           // Mark read
-          prim[p].set_temp(0);
+          loc = 0;
 
           // Replace parameter with input instruction
           algorithm_[i].data.own(new Input(prim[p].sparsity(), ind, p, nz_offset));
@@ -402,13 +407,9 @@ namespace casadi {
     // Locate free variables
     free_vars_.clear();
     for (auto it=symb_loc.begin(); it!=symb_loc.end(); ++it) {
-      casadi_int i = it->second->temp-1;
-      if (i>=0) {
+      if (input_loc.get(it->second)!=0) {
         // Save to list of free parameters
         free_vars_.push_back(MX::create(it->second));
-
-        // Remove marker
-        it->second->temp=0;
       }
     }
 
@@ -603,6 +604,13 @@ namespace casadi {
     return 0;
   }
 
+  bool MXFunction::has_sp_parallel() const {
+    for (auto&& e : algorithm_) {
+      if (e.op==OP_CALL) return false;
+    }
+    return true;
+  }
+
   int MXFunction::sp_reverse(bvec_t** arg, bvec_t** res,
       casadi_int* iw, bvec_t* w, void* mem) const {
     // Fall back when reverse mode not allowed
@@ -1287,7 +1295,7 @@ namespace casadi {
           g.init_local("w" + g.format_padded(i), "w+" + str(workloc_[i]));
         }
         if (needs_reference[i]) {
-          g.local("wr" + str(i), "const casadi_real", "*");
+          g.local("wr" + g.format_padded(i), "const casadi_real", "*");
         }
       }
     }
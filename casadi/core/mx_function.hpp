@@ -148,6 +148,9 @@ namespace casadi {
         \identifier{29} */
     void init(const Dict& opts) override;
 
+    /** \brief Symbolic primitives of an input expression */
+    static std::vector<MXNode*> symbolic_nodes(const MX& x);
+
     /** \brief Generate code for the declarations of the C function
 
         \identifier{2a} */
@@ -227,6 +230,9 @@ namespace casadi {
         \identifier{2m} */
     int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
 
+    /// Concurrent sparsity propagation, unless there are function calls
+    bool has_sp_parallel() const override;
+
     // print an element of an algorithm
     std::string print(const AlgEl& el) const;
 
@@ -0,0 +1,376 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "native_code.hpp"
+#include "calculus.hpp"
+
+#include <cstring>
+#include <limits>
+
+#if defined(__x86_64__) && !defined(_WIN32)
+#define CASADI_NATIVE_X86_64
+#include <sys/mman.h>
+#endif
+
+namespace casadi {
+
+#ifdef CASADI_NATIVE_X86_64
+
+  // Call-out for operations without inline code
+  static double native_fun(int op, double x, double y) {
+    double f;
+    casadi_math<double>::fun(op, x, y, f);
+    return f;
+  }
+
+  // General purpose registers
+  enum {RAX=0, RBX=3, RSI=6, RDI=7, R12=12, R13=13, R14=14, R15=15};
+
+  // Registers holding the pointers passed to the emitted code
+  static const int reg_arg = RBX, reg_res = R12, reg_w = R13, reg_c = R14, reg_fun = R15;
+
+  // Number of xmm registers
+  static const int n_xmm = 16;
+
+  // x86-64 instruction encoder
+  class X86Emitter {
+  public:
+    std::vector<unsigned char> b;
+
+    void byte(unsigned int v) { b.push_back(static_cast<unsigned char>(v));}
+
+    void imm32(int32_t v) {
+      for (int i=0; i<4; ++i) byte((static_cast<uint32_t>(v) >> (8*i)) & 0xff);
+    }
+
+    void imm64(uint64_t v) {
+      for (int i=0; i<8; ++i) byte((v >> (8*i)) & 0xff);
+    }
+
+    // REX prefix, omitted when not needed
+    void rex(bool w, int r, int base) {
+      unsigned int v = 0x40 | (w << 3) | ((r >= 8) << 2) | (base >= 8);
+      if (v != 0x40) byte(v);
+    }
+
+    // ModRM for [base + disp32]
+    void mem(int r, int base, int32_t disp) {
+      byte(0x80 | ((r & 7) << 3) | (base & 7));
+      if ((base & 7) == 4) byte(0x24);
+      imm32(disp);
+    }
+
+    // ModRM for a register operand
+    void reg(int r, int rm) {
+      byte(0xc0 | ((r & 7) << 3) | (rm & 7));
+    }
+
+    // SSE2 instruction, register operands
+    void sse(unsigned int pfx, unsigned int opc, int r, int rm) {
+      byte(pfx);
+      rex(false, r, rm);
+      byte(0x0f);
+      byte(opc);
+      reg(r, rm);
+    }
+
+    // SSE2 instruction, memory operand
+    void sse_mem(unsigned int pfx, unsigned int opc, int r, int base, int32_t disp) {
+      byte(pfx);
+      rex(false, r, base);
+      byte(0x0f);
+      byte(opc);
+      mem(r, base, disp);
+    }
+
+    void movsd_load(int x, int base, int32_t disp) { sse_mem(0xf2, 0x10, x, base, disp);}
+    void movsd_store(int x, int base, int32_t disp) { sse_mem(0xf2, 0x11, x, base, disp);}
+    void movapd(int d, int s) { if (d!=s) sse(0x66, 0x28, d, s);}
+    void xorpd(int d, int s) { sse(0x66, 0x57, d, s);}
+
+    // mov r64, [base + disp32]
+    void mov_load(int r, int base, int32_t disp) {
+      rex(true, r, base);
+      byte(0x8b);
+      mem(r, base, disp);
+    }
+
+    // mov r64, r64
+    void mov(int d, int s) {
+      rex(true, s, d);
+      byte(0x89);
+      reg(s, d);
+    }
+
+    // mov r64, imm64
+    void mov_imm(int d, uint64_t v) {
+      rex(true, 0, d);
+      byte(0xb8 + (d & 7));
+      imm64(v);
+    }
+
+    void push(int r) { rex(false, 0, r); byte(0x50 + (r & 7));}
+    void pop(int r) { rex(false, 0, r); byte(0x58 + (r & 7));}
+
+    // Flip the sign bit of an xmm register, through rax
+    void neg(int d, int s) {
+      // movq rax, s
+      byte(0x66); rex(true, s, RAX); byte(0x0f); byte(0x7e); reg(s, RAX);
+      // btc rax, 63
+      byte(0x48); byte(0x0f); byte(0xba); byte(0xf8); byte(63);
+      // movq d, rax
+      byte(0x66); rex(true, d, RAX); byte(0x0f); byte(0x6e); reg(d, RAX);
+    }
+
+    // Skip the code emitted between skip_begin and skip_end if rax is null
+    size_t skip_begin() {
+      // test rax, rax; jz rel8
+      byte(0x48); byte(0x85); byte(0xc0);
+      byte(0x74); byte(0);
+      return b.size();
+    }
+    void skip_end(size_t pos) {
+      b[pos-1] = static_cast<unsigned char>(b.size() - pos);
+    }
+  };
+
+  // Work vector entries cached in xmm registers, written through to memory
+  class XmmCache {
+  public:
+    XmmCache() : t_(0) { clear();}
+
+    void clear() {
+      for (int r=0; r<n_xmm; ++r) {
+        slot_[r] = -1;
+        used_[r] = 0;
+      }
+    }
+
+    // Register holding an entry, loading it if needed
+    int get(X86Emitter& e, int slot, int excl=-1) {
+      for (int r=0; r<n_xmm; ++r) {
+        if (slot_[r]==slot) {
+          used_[r] = ++t_;
+          return r;
+        }
+      }
+      int r = alloc(excl);
+      e.movsd_load(r, reg_w, disp(slot));
+      slot_[r] = slot;
+      return r;
+    }
+
+    // Free or least recently used register
+    int alloc(int excl1=-1, int excl2=-1) {
+      int best = -1;
+      for (int r=0; r<n_xmm; ++r) {
+        if (r==excl1 || r==excl2) continue;
+        if (slot_[r]==-1) {
+          best = r;
+          break;
+        }
+        if (best==-1 || used_[r] < used_[best]) best = r;
+      }
+      used_[best] = ++t_;
+      slot_[best] = -1;
+      return best;
+    }
+
+    // Register now holds a (new) value of an entry
+    void define(int r, int slot) {
+      for (int q=0; q<n_xmm; ++q) {
+        if (slot_[q]==slot) slot_[q] = -1;
+      }
+      slot_[r] = slot;
+      used_[r] = ++t_;
+    }
+
+    static int32_t disp(casadi_int i) {
+      casadi_assert_dev(i>=0 && 8*i <= std::numeric_limits<int32_t>::max());
+      return static_cast<int32_t>(8*i);
+    }
+
+  private:
+    int slot_[n_xmm];
+    casadi_int used_[n_xmm];
+    casadi_int t_;
+  };
+
+  bool NativeCode::available() {
+    return true;
+  }
+
+  bool NativeCode::supported(const std::vector<ScalarAtomic>& algorithm) {
+    for (auto&& a : algorithm) {
+      if (a.op==OP_CALL) return false;
+      // Free variables
+      if (a.op==OP_PARAMETER) return false;
+    }
+    return true;
+  }
+
+  NativeCode::NativeCode(const std::vector<ScalarAtomic>& algorithm) {
+    casadi_assert_dev(supported(algorithm));
+    X86Emitter e;
+    XmmCache x;
+
+    // Prologue: save callee-saved registers, stack is 16-byte aligned afterwards
+    e.push(RBX);
+    e.push(R12);
+    e.push(R13);
+    e.push(R14);
+    e.push(R15);
+    e.mov(reg_arg, RDI);
+    e.mov(reg_res, RSI);
+    e.mov(reg_w, 2);  // rdx
+    e.mov(reg_c, 1);  // rcx
+    e.mov_imm(reg_fun, reinterpret_cast<uint64_t>(&native_fun));
+
+    for (auto&& a : algorithm) {
+      int r, r1, r2;
+      switch (a.op) {
+        case OP_CONST:
+          r = x.alloc();
+          e.movsd_load(r, reg_c, XmmCache::disp(c_.size()));
+          c_.push_back(a.d);
+          e.movsd_store(r, reg_w, XmmCache::disp(a.i0));
+          x.define(r, a.i0);
+          break;
+        case OP_INPUT:
+          {
+            r = x.alloc();
+            e.xorpd(r, r);
+            e.mov_load(RAX, reg_arg, XmmCache::disp(a.i1));
+            size_t skip = e.skip_begin();
+            e.movsd_load(r, RAX, XmmCache::disp(a.i2));
+            e.skip_end(skip);
+            e.movsd_store(r, reg_w, XmmCache::disp(a.i0));
+            x.define(r, a.i0);
+          }
+          break;
+        case OP_OUTPUT:
+          {
+            // Load before branching, the cache state must not depend on the branch
+            r = x.get(e, a.i1);
+            e.mov_load(RAX, reg_res, XmmCache::disp(a.i0));
+            size_t skip = e.skip_begin();
+            e.movsd_store(r, RAX, XmmCache::disp(a.i2));
+            e.skip_end(skip);
+          }
+          break;
+        case OP_ADD:
+        case OP_SUB:
+        case OP_MUL:
+        case OP_DIV:
+          {
+            r1 = x.get(e, a.i1);
+            r2 = x.get(e, a.i2, r1);
+            r = x.alloc(r1, r2);
+            e.movapd(r, r1);
+            unsigned int opc = a.op==OP_ADD ? 0x58 : a.op==OP_SUB ? 0x5c :
+              a.op==OP_MUL ? 0x59 : 0x5e;
+            e.sse(0xf2, opc, r, r2);
+            e.movsd_store(r, reg_w, XmmCache::disp(a.i0));
+            x.define(r, a.i0);
+          }
+          break;
+        case OP_NEG:
+        case OP_SQ:
+        case OP_TWICE:
+        case OP_SQRT:
+          r1 = x.get(e, a.i1);
+          r = x.alloc(r1);
+          if (a.op==OP_NEG) {
+            e.neg(r, r1);
+          } else if (a.op==OP_SQRT) {
+            e.sse(0xf2, 0x51, r, r1);
+          } else {
+            e.movapd(r, r1);
+            // 2*x is exactly x+x
+            e.sse(0xf2, a.op==OP_SQ ? 0x59 : 0x58, r, r);
+          }
+          e.movsd_store(r, reg_w, XmmCache::disp(a.i0));
+          x.define(r, a.i0);
+          break;
+        default:
+          // Call out, all xmm registers are caller-saved
+          e.movsd_load(0, reg_w, XmmCache::disp(a.i1));
+          e.movsd_load(1, reg_w, XmmCache::disp(a.i2));
+          e.byte(0xbf);  // mov edi, imm32
+          e.imm32(a.op);
+          e.byte(0x41); e.byte(0xff); e.byte(0xd7);  // call r15
+          e.movsd_store(0, reg_w, XmmCache::disp(a.i0));
+          x.clear();
+          x.define(0, a.i0);
+      }
+    }
+
+    // Epilogue
+    e.pop(R15);
+    e.pop(R14);
+    e.pop(R13);
+    e.pop(R12);
+    e.pop(RBX);
+    e.byte(0xc3);
+
+    // Copy to executable memory
+    size_ = e.b.size();
+    mem_size_ = size_;
+    mem_ = mmap(nullptr, mem_size_, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    casadi_assert(mem_!=MAP_FAILED, "Cannot allocate memory for native code");
+    std::memcpy(mem_, get_ptr(e.b), size_);
+    if (mprotect(mem_, mem_size_, PROT_READ | PROT_EXEC) != 0) {
+      munmap(mem_, mem_size_);
+      casadi_error("Cannot make native code executable. "
+        "The host may forbid writable memory to become executable.");
+    }
+    fcn_ = reinterpret_cast<Fcn>(mem_);
+  }
+
+  NativeCode::~NativeCode() {
+    munmap(mem_, mem_size_);
+  }
+
+#else // CASADI_NATIVE_X86_64
+
+  bool NativeCode::available() {
+    return false;
+  }
+
+  bool NativeCode::supported(const std::vector<ScalarAtomic>& algorithm) {
+    return false;
+  }
+
+  NativeCode::NativeCode(const std::vector<ScalarAtomic>& algorithm) {
+    casadi_error("Native code is only available on x86-64 hosts");
+  }
+
+  NativeCode::~NativeCode() {
+  }
+
+#endif // CASADI_NATIVE_X86_64
+
+} // namespace casadi
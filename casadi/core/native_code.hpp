@@ -0,0 +1,92 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_NATIVE_CODE_HPP
+#define CASADI_NATIVE_CODE_HPP
+
+#include "sx_function.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Machine code for an SXFunction algorithm, emitted in-process
+
+      The algorithm is lowered to x86-64 SSE2 instructions in executable memory,
+      without invoking an external compiler. Arithmetic is emitted inline and
+      work vector entries are cached in the xmm registers. All other operations
+      call out to casadi_math. Call nodes are not supported.
+
+      Only available on x86-64 hosts with the System V calling convention.
+  */
+  class CASADI_EXPORT NativeCode {
+  public:
+    /// Can machine code be emitted on this host?
+    static bool available();
+
+    /// Can an algorithm be lowered?
+    static bool supported(const std::vector<ScalarAtomic>& algorithm);
+
+    /// Emit machine code for an algorithm
+    explicit NativeCode(const std::vector<ScalarAtomic>& algorithm);
+
+    /// Destructor, releases the executable memory
+    ~NativeCode();
+
+    /// Evaluate, w must hold the work vector of the algorithm
+    void operator()(const double** arg, double** res, double* w) const {
+      fcn_(arg, res, w, get_ptr(c_));
+    }
+
+    /// Size of the emitted code in bytes
+    size_t size() const { return size_;}
+
+  private:
+    // Signature of the emitted code
+    typedef void (*Fcn)(const double** arg, double** res, double* w, const double* c);
+
+    // Not copyable, owns the executable memory
+    NativeCode(const NativeCode&);
+    NativeCode& operator=(const NativeCode&);
+
+    // Entry point
+    Fcn fcn_;
+
+    // Executable memory
+    void* mem_;
+    size_t mem_size_;
+
+    // Size of the emitted code
+    size_t size_;
+
+    // Constant pool
+    std::vector<double> c_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_NATIVE_CODE_HPP
@@ -58,6 +58,99 @@ void casadi_ldl(const casadi_int* sp_a, const T1* a,
   }
 }
 
+// SYMBOL "ldl_sn_node"
+// Factorize one supernode of a supernodal LDL^T factorization, cf. casadi_ldl_sn
+// All descendant supernodes must have been factorized
+// len[w] >= n, len[iw] >= n
+template<typename T1>
+void casadi_ldl_sn_node(const casadi_int* sn, casadi_int s, T1* d, T1* v,
+                        T1* w, casadi_int* iw) {
+  const casadi_int *sn_col, *sn_row, *sn_val, *row, *upd_ptr, *upd, *rs, *rs2;
+  casadi_int ns, s2, f, nc, nc2, m, m2, u, p1, p2, i, j, k;
+  T1 t, *vs, *vs2, *vj;
+  // Extract symbolic data
+  ns = sn[1];
+  sn_col = sn + 2; sn_row = sn_col + ns + 1; sn_val = sn_row + ns + 1;
+  row = sn_val + ns + 1; upd_ptr = row + sn_row[ns]; upd = upd_ptr + ns + 1;
+  f = sn_col[s]; nc = sn_col[s+1] - f;
+  m = sn_row[s+1] - sn_row[s]; rs = row + sn_row[s];
+  vs = v + sn_val[s];
+  // Relative position of the rows in the supernode
+  for (i=0; i<m; ++i) iw[rs[i]] = i;
+  // Dense updates from descendant supernodes: L(R,J) -= L(R,K) D(K) L(J,K)'
+  for (u=upd_ptr[s]; u<upd_ptr[s+1]; ++u) {
+    s2 = upd[3*u]; p1 = upd[3*u+1]; p2 = upd[3*u+2];
+    nc2 = sn_col[s2+1] - sn_col[s2];
+    m2 = sn_row[s2+1] - sn_row[s2]; rs2 = row + sn_row[s2];
+    vs2 = v + sn_val[s2];
+    for (j=p1; j<p2; ++j) {
+      for (i=j; i<m2; ++i) w[i] = 0;
+      for (k=0; k<nc2; ++k) {
+        t = vs2[j + k*m2] * vs2[k + k*m2];
+        for (i=j; i<m2; ++i) w[i] += vs2[i + k*m2] * t;
+      }
+      vj = vs + (rs2[j] - f)*m;
+      for (i=j; i<m2; ++i) vj[iw[rs2[i]]] -= w[i];
+    }
+  }
+  // Dense LDL^T of the supernode, D stored on the diagonal
+  for (j=0; j<nc; ++j) {
+    vj = vs + j*m;
+    for (k=0; k<j; ++k) {
+      t = vs[j + k*m] * vs[k + k*m];
+      for (i=j; i<m; ++i) vj[i] -= vs[i + k*m] * t;
+    }
+    for (i=j+1; i<m; ++i) vj[i] /= vj[j];
+    d[f + j] = vj[j];
+  }
+}
+
+// SYMBOL "ldl_sn_assemble"
+// Copy the nonzeros of A into the dense supernode storage, cf. casadi_ldl_sn
+template<typename T1>
+void casadi_ldl_sn_assemble(const casadi_int* sn, const T1* a, T1* v) {
+  const casadi_int *sn_val, *upd_ptr, *a_map;
+  casadi_int ns, nupd, nnz_a, k;
+  ns = sn[1];
+  sn_val = sn + 2 + 2*(ns + 1);
+  upd_ptr = sn_val + ns + 1 + sn[2 + 2*ns + 1];
+  nupd = upd_ptr[ns];
+  nnz_a = upd_ptr[ns + 1 + 3*nupd]; a_map = upd_ptr + ns + 1 + 3*nupd + 1;
+  for (k=0; k<sn_val[ns]; ++k) v[k] = 0;
+  for (k=0; k<nnz_a; ++k) if (a_map[k]>=0) v[a_map[k]] = a[k];
+}
+
+// SYMBOL "ldl_sn_lt"
+// Extract the nonzeros of the transposed L factor from the supernode storage
+template<typename T1>
+void casadi_ldl_sn_lt(const casadi_int* sn, const T1* v, T1* lt) {
+  const casadi_int *upd_ptr, *lt_map;
+  casadi_int ns, nupd, nnz_a, nnz_lt, k;
+  ns = sn[1];
+  upd_ptr = sn + 2 + 3*(ns + 1) + sn[2 + 2*ns + 1];
+  nupd = upd_ptr[ns];
+  nnz_a = upd_ptr[ns + 1 + 3*nupd];
+  nnz_lt = upd_ptr[ns + 1 + 3*nupd + 1 + nnz_a];
+  lt_map = upd_ptr + ns + 1 + 3*nupd + 1 + nnz_a + 1;
+  for (k=0; k<nnz_lt; ++k) lt[k] = v[lt_map[k]];
+}
+
+// SYMBOL "ldl_sn"
+// Supernodal LDL^T factorization, with the same output as casadi_ldl
+// The supernode partition, dense storage layout and assembly maps are encoded in sn:
+// [n, ns, col[ns+1], row_ptr[ns+1], val_ptr[ns+1], row[], upd_ptr[ns+1], upd[3*nupd],
+//  nnz_a, a_map[nnz_a], nnz_lt, lt_map[nnz_lt]]
+// Supernodes are numbered in a topological order of the elimination tree
+// len[v] >= val_ptr[ns], len[w] >= n, len[iw] >= n
+template<typename T1>
+void casadi_ldl_sn(const casadi_int* sn, const T1* a, T1* lt, T1* d, T1* v,
+                   T1* w, casadi_int* iw) {
+  casadi_int s;
+  casadi_ldl_sn_assemble(sn, a, v);
+  for (s=0; s<sn[1]; ++s) casadi_ldl_sn_node(sn, s, d, v, w, iw);
+  casadi_ldl_sn_lt(sn, v, lt);
+}
+
 // SYMBOL "ldl_trs"
 // Solve for (I+R) with R an optionally transposed strictly upper triangular matrix.
 template<typename T1>
@@ -107,3 +200,76 @@ void casadi_ldl_solve(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1*
     x += n;
   }
 }
+
+// SYMBOL "ldl_trs_block"
+// Solve for (I+R) with R an optionally transposed strictly upper triangular matrix,
+// for nb right-hand sides stored row by row, i.e. x[i*nb+j] is entry i of rhs j
+template<typename T1>
+void casadi_ldl_trs_block(const casadi_int* sp_r, const T1* nz_r, T1* x, casadi_int nb,
+                          casadi_int tr) {
+  casadi_int ncol, c, k, j;
+  const casadi_int *colind, *row;
+  T1 a, *xc, *xr;
+  // Extract sparsity
+  ncol=sp_r[1];
+  colind=sp_r+2; row=sp_r+2+ncol+1;
+  if (tr) {
+    // Forward substitution
+    for (c=0; c<ncol; ++c) {
+      xc = x + c*nb;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        a = nz_r[k];
+        xr = x + row[k]*nb;
+        for (j=0; j<nb; ++j) xc[j] -= a*xr[j];
+      }
+    }
+  } else {
+    // Backward substitution
+    for (c=ncol-1; c>=0; --c) {
+      xc = x + c*nb;
+      for (k=colind[c+1]-1; k>=colind[c]; --k) {
+        a = nz_r[k];
+        xr = x + row[k]*nb;
+        for (j=0; j<nb; ++j) xr[j] -= a*xc[j];
+      }
+    }
+  }
+}
+
+// SYMBOL "ldl_solve_block"
+// Linear solve using an LDL^T factorized linear system, as casadi_ldl_solve
+// The right-hand sides are processed in panels of up to nb columns
+// len[w] >= n*nb
+template<typename T1>
+void casadi_ldl_solve_block(T1* x, casadi_int nrhs, const casadi_int* sp_lt, const T1* lt,
+                            const T1* d, const casadi_int* p, T1* w, casadi_int nb) {
+  casadi_int i, j, m;
+  casadi_int n = sp_lt[1];
+  for (; nrhs>0; nrhs-=m) {
+    m = nrhs<nb ? nrhs : nb;
+    if (m==1) {
+      // Single right-hand side
+      casadi_ldl_solve(x, 1, sp_lt, lt, d, p, w);
+      x += n;
+      continue;
+    }
+    // Multiply by P, storing the panel row by row
+    for (j=0; j<m; ++j) {
+      for (i=0; i<n; ++i) w[i*m+j] = x[j*n+p[i]];
+    }
+    //  Solve for L
+    casadi_ldl_trs_block(sp_lt, lt, w, m, 1);
+    // Divide by D
+    for (i=0; i<n; ++i) {
+      for (j=0; j<m; ++j) w[i*m+j] /= d[i];
+    }
+    // Solve for L'
+    casadi_ldl_trs_block(sp_lt, lt, w, m, 0);
+    // Multiply by P'
+    for (j=0; j<m; ++j) {
+      for (i=0; i<n; ++i) x[j*n+p[i]] = w[i*m+j];
+    }
+    // Next panel
+    x += m*n;
+  }
+}
@@ -40,6 +40,50 @@ T1 casadi_house(T1* v, T1* beta, casadi_int nv) {
   return s;
 }
 
+// SYMBOL "qr_col"
+// Compute column c of a numeric QR factorization, cf. casadi_qr
+// All columns of R(:,c) above the diagonal must have been computed
+// x must be zero on entry and is zero on return, len[x] = nrow
+template<typename T1>
+void casadi_qr_col(const casadi_int* sp_a, const T1* nz_a, T1* x,
+                   const casadi_int* sp_v, T1* nz_v, const casadi_int* sp_r, T1* nz_r, T1* beta,
+                   const casadi_int* prinv, const casadi_int* pc, casadi_int c) {
+   // Local variables
+   casadi_int ncol, r, k, k1;
+   T1 alpha;
+   const casadi_int *a_colind, *a_row, *v_colind, *v_row, *r_colind, *r_row;
+   // Extract sparsities
+   ncol = sp_a[1];
+   a_colind=sp_a+2; a_row=sp_a+2+ncol+1;
+   v_colind=sp_v+2; v_row=sp_v+2+ncol+1;
+   r_colind=sp_r+2; r_row=sp_r+2+ncol+1;
+   // Copy (permuted) column of A to x
+   for (k=a_colind[pc[c]]; k<a_colind[pc[c]+1]; ++k) x[prinv[a_row[k]]] = nz_a[k];
+   // Use the equality R = (I-betan*vn*vn')*...*(I-beta1*v1*v1')*A to get
+   // strictly upper triangular entries of R
+   nz_r += r_colind[c];
+   for (k=r_colind[c]; k<r_colind[c+1] && (r=r_row[k])<c; ++k) {
+     // Calculate scalar factor alpha = beta(r)*dot(v(:,r), x)
+     alpha = 0;
+     for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) alpha += nz_v[k1]*x[v_row[k1]];
+     alpha *= beta[r];
+     // x -= alpha*v(:,r)
+     for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) x[v_row[k1]] -= alpha*nz_v[k1];
+     // Get r entry
+     *nz_r++ = x[r];
+     // Strictly upper triangular entries in x no longer needed
+     x[r] = 0;
+   }
+   // Get V column
+   for (k=v_colind[c]; k<v_colind[c+1]; ++k) {
+     nz_v[k] = x[v_row[k]];
+     // Lower triangular entries of x no longer needed
+     x[v_row[k]] = 0;
+   }
+   // Get diagonal entry of R, normalize V column
+   *nz_r = casadi_house(nz_v + v_colind[c], beta + c, v_colind[c+1] - v_colind[c]);
+}
+
 // SYMBOL "qr"
 // Numeric QR factorization
 // Ref: Chapter 5, Direct Methods for Sparse Linear Systems by Tim Davis
@@ -54,44 +98,50 @@ void casadi_qr(const casadi_int* sp_a, const T1* nz_a, T1* x,
                const casadi_int* sp_v, T1* nz_v, const casadi_int* sp_r, T1* nz_r, T1* beta,
                const casadi_int* prinv, const casadi_int* pc) {
    // Local variables
-   casadi_int ncol, nrow, r, c, k, k1;
-   T1 alpha;
-   const casadi_int *a_colind, *a_row, *v_colind, *v_row, *r_colind, *r_row;
-   // Extract sparsities
+   casadi_int ncol, nrow, r, c;
+   ncol = sp_a[1];
+   nrow = sp_v[0];
+   // Clear work vector
+   for (r=0; r<nrow; ++r) x[r] = 0;
+   // Loop over columns of R, A and V
+   for (c=0; c<ncol; ++c) {
+     casadi_qr_col(sp_a, nz_a, x, sp_v, nz_v, sp_r, nz_r, beta, prinv, pc, c);
+   }
+ }
+
+// SYMBOL "qr_partial"
+// Update a numeric QR factorization after some columns of A have changed
+// Recomputes the marked columns and the columns depending on them,
+// giving the same result as casadi_qr
+// mark[c] is nonzero if column pc[c] of A has changed, marks recomputed columns on return
+// len[x] = nrow, len[mark] = ncol
+// Returns the number of recomputed columns
+template<typename T1>
+casadi_int casadi_qr_partial(const casadi_int* sp_a, const T1* nz_a, T1* x,
+                             const casadi_int* sp_v, T1* nz_v, const casadi_int* sp_r, T1* nz_r,
+                             T1* beta, const casadi_int* prinv, const casadi_int* pc,
+                             casadi_int* mark) {
+   // Local variables
+   casadi_int ncol, nrow, r, c, k, n_upd;
+   const casadi_int *r_colind, *r_row;
    ncol = sp_a[1];
-   a_colind=sp_a+2; a_row=sp_a+2+ncol+1;
    nrow = sp_v[0];
-   v_colind=sp_v+2; v_row=sp_v+2+ncol+1;
    r_colind=sp_r+2; r_row=sp_r+2+ncol+1;
    // Clear work vector
    for (r=0; r<nrow; ++r) x[r] = 0;
    // Loop over columns of R, A and V
+   n_upd = 0;
    for (c=0; c<ncol; ++c) {
-     // Copy (permuted) column of A to x
-     for (k=a_colind[pc[c]]; k<a_colind[pc[c]+1]; ++k) x[prinv[a_row[k]]] = nz_a[k];
-     // Use the equality R = (I-betan*vn*vn')*...*(I-beta1*v1*v1')*A to get
-     // strictly upper triangular entries of R
-     for (k=r_colind[c]; k<r_colind[c+1] && (r=r_row[k])<c; ++k) {
-       // Calculate scalar factor alpha = beta(r)*dot(v(:,r), x)
-       alpha = 0;
-       for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) alpha += nz_v[k1]*x[v_row[k1]];
-       alpha *= beta[r];
-       // x -= alpha*v(:,r)
-       for (k1=v_colind[r]; k1<v_colind[r+1]; ++k1) x[v_row[k1]] -= alpha*nz_v[k1];
-       // Get r entry
-       *nz_r++ = x[r];
-       // Strictly upper triangular entries in x no longer needed
-       x[r] = 0;
+     // Column depends on a recomputed column?
+     for (k=r_colind[c]; !mark[c] && k<r_colind[c+1] && (r=r_row[k])<c; ++k) {
+       if (mark[r]) mark[c] = 1;
      }
-     // Get V column
-     for (k=v_colind[c]; k<v_colind[c+1]; ++k) {
-       nz_v[k] = x[v_row[k]];
-       // Lower triangular entries of x no longer needed
-       x[v_row[k]] = 0;
-     }
-     // Get diagonal entry of R, normalize V column
-     *nz_r++ = casadi_house(nz_v + v_colind[c], beta + c, v_colind[c+1] - v_colind[c]);
+     if (!mark[c]) continue;
+     // Recompute column
+     casadi_qr_col(sp_a, nz_a, x, sp_v, nz_v, sp_r, nz_r, beta, prinv, pc, c);
+     n_upd++;
    }
+   return n_upd;
  }
 
 // SYMBOL "qr_mv"
@@ -270,3 +320,137 @@ void casadi_qr_colcomb(T1* v, const T1* nz_r, const casadi_int* sp_r,
   // Normalize v
   casadi_scal(ncol, 1./sqrt(casadi_dot(ncol, v, v)), v);
 }
+
+// SYMBOL "qr_mv_block"
+// Multiply with Q or Q' as casadi_qr_mv, for nb vectors stored row by row,
+// i.e. x[i*nb+j] is entry i of vector j
+// len[alpha] >= nb
+template<typename T1>
+void casadi_qr_mv_block(const casadi_int* sp_v, const T1* v, const T1* beta, T1* x,
+                        casadi_int nb, casadi_int tr, T1* alpha) {
+  // Local variables
+  casadi_int ncol, c, c1, k, j;
+  T1 a, *xr;
+  const casadi_int *colind, *row;
+  // Extract sparsity
+  ncol=sp_v[1];
+  colind=sp_v+2; row=sp_v+2+ncol+1;
+  // Loop over vectors
+  for (c1=0; c1<ncol; ++c1) {
+    // Forward order for transpose, otherwise backwards
+    c = tr ? c1 : ncol-1-c1;
+    // Calculate scalar factors alpha = beta(c)*dot(v(:,c), x)
+    for (j=0; j<nb; ++j) alpha[j] = 0;
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      a = v[k];
+      xr = x + row[k]*nb;
+      for (j=0; j<nb; ++j) alpha[j] += a*xr[j];
+    }
+    for (j=0; j<nb; ++j) alpha[j] *= beta[c];
+    // x -= alpha*v(:,c)
+    for (k=colind[c]; k<colind[c+1]; ++k) {
+      a = v[k];
+      xr = x + row[k]*nb;
+      for (j=0; j<nb; ++j) xr[j] -= alpha[j]*a;
+    }
+  }
+}
+
+// SYMBOL "qr_trs_block"
+// Solve for an (optionally transposed) upper triangular matrix R as casadi_qr_trs,
+// for nb right-hand sides stored row by row
+template<typename T1>
+void casadi_qr_trs_block(const casadi_int* sp_r, const T1* nz_r, T1* x, casadi_int nb,
+                         casadi_int tr) {
+  // Local variables
+  casadi_int ncol, r, c, k, j;
+  T1 a, *xc, *xr;
+  const casadi_int *colind, *row;
+  // Extract sparsity
+  ncol=sp_r[1];
+  colind=sp_r+2; row=sp_r+2+ncol+1;
+  if (tr) {
+    // Forward substitution
+    for (c=0; c<ncol; ++c) {
+      xc = x + c*nb;
+      for (k=colind[c]; k<colind[c+1]; ++k) {
+        r = row[k];
+        a = nz_r[k];
+        if (r==c) {
+          for (j=0; j<nb; ++j) xc[j] /= a;
+        } else {
+          xr = x + r*nb;
+          for (j=0; j<nb; ++j) xc[j] -= a*xr[j];
+        }
+      }
+    }
+  } else {
+    // Backward substitution
+    for (c=ncol-1; c>=0; --c) {
+      xc = x + c*nb;
+      for (k=colind[c+1]-1; k>=colind[c]; --k) {
+        r = row[k];
+        a = nz_r[k];
+        if (r==c) {
+          for (j=0; j<nb; ++j) xc[j] /= a;
+        } else {
+          xr = x + r*nb;
+          for (j=0; j<nb; ++j) xr[j] -= a*xc[j];
+        }
+      }
+    }
+  }
+}
+
+// SYMBOL "qr_solve_block"
+// Solve a factorized linear system as casadi_qr_solve
+// The right-hand sides are processed in panels of up to nb columns
+// len[w] >= (max(ncol, nrow_ext)+1)*nb
+template<typename T1>
+void casadi_qr_solve_block(T1* x, casadi_int nrhs, casadi_int tr,
+                           const casadi_int* sp_v, const T1* v, const casadi_int* sp_r,
+                           const T1* r, const T1* beta, const casadi_int* prinv,
+                           const casadi_int* pc, T1* w, casadi_int nb) {
+  casadi_int j, m, c, nrow_ext, ncol, nw;
+  T1* alpha;
+  nrow_ext = sp_v[0]; ncol = sp_v[1];
+  nw = nrow_ext>ncol ? nrow_ext : ncol;
+  alpha = w + nw*nb;
+  for (; nrhs>0; nrhs-=m) {
+    m = nrhs<nb ? nrhs : nb;
+    if (m==1) {
+      // Single right-hand side
+      casadi_qr_solve(x, 1, tr, sp_v, v, sp_r, r, beta, prinv, pc, w);
+    } else if (tr) {
+      // Multiply by PC, storing the panel row by row
+      for (c=ncol*m; c<nw*m; ++c) w[c] = 0;
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) w[c*m+j] = x[j*ncol+pc[c]];
+      }
+      //  Solve for R'
+      casadi_qr_trs_block(sp_r, r, w, m, 1);
+      // Multiply by Q
+      casadi_qr_mv_block(sp_v, v, beta, w, m, 0, alpha);
+      // Multiply by PR'
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) x[j*ncol+c] = w[prinv[c]*m+j];
+      }
+    } else {
+      // Multiply with PR, storing the panel row by row
+      for (c=0; c<nrow_ext*m; ++c) w[c] = 0;
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) w[prinv[c]*m+j] = x[j*ncol+c];
+      }
+      // Multiply with Q'
+      casadi_qr_mv_block(sp_v, v, beta, w, m, 1, alpha);
+      //  Solve for R
+      casadi_qr_trs_block(sp_r, r, w, m, 0);
+      // Multiply with PC'
+      for (j=0; j<m; ++j) {
+        for (c=0; c<ncol; ++c) x[j*ncol+pc[c]] = w[c*m+j];
+      }
+    }
+    // Next panel
+    x += m*ncol;
+  }
+}
@@ -45,6 +45,8 @@ struct casadi_qrqp_prob {
   casadi_int max_iter;
   // Primal and dual error tolerance
   T1 constr_viol_tol, dual_inf_tol;
+  // Update the QR factorization incrementally on active-set changes
+  int partial_fact;
 };
 // C-REPLACE "casadi_qrqp_prob<T1>" "struct casadi_qrqp_prob"
 
@@ -57,6 +59,7 @@ void casadi_qrqp_setup(casadi_qrqp_prob<T1>* p) {
   p->max_iter = 1000;
   p->constr_viol_tol = 1e-8;
   p->dual_inf_tol = 1e-8;
+  p->partial_fact = 1;
 }
 
 // SYMBOL "qrqp_flag_t"
@@ -81,6 +84,11 @@ struct casadi_qrqp_data {
   // Vectors
   T1 *lbz, *ubz, *z, *infeas, *tinfeas, *sens, *lam, *w, *dz, *dlam;
   casadi_int *iw, *neverzero, *neverlower, *neverupper, *lincomb;
+  // Active set of the current QR factorization, if any
+  casadi_int *fact_active;
+  int has_fact;
+  // Number of partially updated factorizations
+  casadi_int n_partial_fact;
   // Numeric QR factorization
   T1 *nz_at, *nz_kkt, *beta, *nz_v, *nz_r;
   // Message buffer
@@ -143,6 +151,7 @@ void casadi_qrqp_work(const casadi_qrqp_prob<T1>* p, casadi_int* sz_arg, casadi_
   *sz_iw += p->qp->nz; // neverupper
   *sz_iw += p->qp->nz; // neverlower
   *sz_iw += p->qp->nz; // lincomb
+  *sz_iw += p->qp->nz; // fact_active
 }
 
 // SYMBOL "qrqp_init"
@@ -173,6 +182,7 @@ void casadi_qrqp_init(casadi_qrqp_data<T1>* d, casadi_int** iw, T1** w) {
   d->neverupper = *iw; *iw += p->qp->nz;
   d->neverlower = *iw; *iw += p->qp->nz;
   d->lincomb = *iw; *iw += p->qp->nz;
+  d->fact_active = *iw; *iw += p->qp->nz;
   d->w = *w;
   d->iw = *iw;
 
@@ -218,6 +228,9 @@ int casadi_qrqp_reset(casadi_qrqp_data<T1>* d) {
   d->r_sign = 0;
   // Reset iteration counter
   d->iter = 0;
+  // No factorization to update
+  d->has_fact = 0;
+  d->n_partial_fact = 0;
   return 0;
 }
 
@@ -697,6 +710,8 @@ int casadi_qrqp_flip_check(casadi_qrqp_data<T1>* d) {
 // SYMBOL "qrqp_factorize"
 template<typename T1>
 void casadi_qrqp_factorize(casadi_qrqp_data<T1>* d) {
+  // Local variables
+  casadi_int c, i;
   const casadi_qrqp_prob<T1>* p = d->prob;
   // Do we already have a search direction due to lost singularity?
   if (d->has_search_dir) {
@@ -706,8 +721,21 @@ void casadi_qrqp_factorize(casadi_qrqp_data<T1>* d) {
   // Construct the KKT matrix
   casadi_qrqp_kkt(d);
   // QR factorization
-  casadi_qr(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r,
-            d->nz_r, d->beta, p->prinv, p->pc);
+  if (d->has_fact && p->partial_fact) {
+    // Only recompute what depends on the KKT rows of the flipped constraints
+    for (c=0; c<p->qp->nz; ++c) {
+      i = p->pc[c];
+      d->iw[c] = (d->lam[i]!=0.) != d->fact_active[i];
+    }
+    casadi_qr_partial(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r,
+                      d->nz_r, d->beta, p->prinv, p->pc, d->iw);
+    d->n_partial_fact++;
+  } else {
+    casadi_qr(p->sp_kkt, d->nz_kkt, d->w, p->sp_v, d->nz_v, p->sp_r,
+              d->nz_r, d->beta, p->prinv, p->pc);
+  }
+  for (i=0; i<p->qp->nz; ++i) d->fact_active[i] = d->lam[i]!=0.;
+  d->has_fact = 1;
   // Check singularity
   d->sing = casadi_qr_singular(&d->mina, &d->imina, d->nz_r, p->sp_r, p->pc, 1e-12);
 }
@@ -821,7 +849,8 @@ int casadi_qrqp_singular_step(casadi_qrqp_data<T1>* d) {
     // One, given search direction
     nk = 1;
   } else {
-    // QR factorization of the transpose
+    // QR factorization of the transpose, overwrites the factorization of the KKT
+    d->has_fact = 0;
     casadi_trans(d->nz_kkt, p->sp_kkt, d->nz_v, p->sp_kkt, d->iw);
     nnz_kkt = p->sp_kkt[2+p->qp->nz]; // kkt_colind[nz]
     casadi_copy(d->nz_v, nnz_kkt, d->nz_kkt);
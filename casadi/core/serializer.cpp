@@ -103,11 +103,26 @@ namespace casadi {
       deserializer_(new DeserializingStream(*dstream_)) {
     }
 
-    FileDeserializer::FileDeserializer(const std::string& fname) :
-        DeserializerBase(std::unique_ptr<std::istream>(
-          new std::ifstream(fname, std::ios_base::binary | std::ios::in))) {
-      if ((dstream_->rdstate() & std::ifstream::failbit) != 0) {
-        casadi_error("Could not open file '" + fname + "' for reading.");
+    FileDeserializer::FileDeserializer(const std::string& fname, const Dict& opts) {
+      bool mmap = false;
+      // Read options
+      for (auto&& op : opts) {
+        if (op.first=="mmap") {
+          mmap = op.second;
+        } else {
+          casadi_error("Unknown option: '" + op.first + "'.");
+        }
+      }
+      if (mmap) {
+        SerializedData source = SerializedData::map_file(fname);
+        dstream_.reset(new SerializedDataStream(source));
+        deserializer_.reset(new DeserializingStream(*dstream_, source));
+      } else {
+        dstream_.reset(new std::ifstream(fname, std::ios_base::binary | std::ios::in));
+        if ((dstream_->rdstate() & std::ifstream::failbit) != 0) {
+          casadi_error("Could not open file '" + fname + "' for reading.");
+        }
+        deserializer_.reset(new DeserializingStream(*dstream_));
       }
     }
 
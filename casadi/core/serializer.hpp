@@ -165,6 +165,10 @@ namespace casadi {
     void reset();
 
   protected:
+#ifndef SWIG
+    /// Streams to be set by derived class
+    DeserializerBase() {}
+#endif // SWIG
     DeserializingStream& deserializer();
     std::unique_ptr<std::istream> dstream_;
     std::unique_ptr<DeserializingStream> deserializer_;
@@ -244,10 +248,14 @@ namespace casadi {
   public:
      /** \brief Advanced deserialization of CasADi objects
      * 
+     * Options: "mmap" memory-maps the file instead of reading it as a stream.
+     * Function cache entries then refer into the mapping and are only
+     * deserialized on first use. The file must not change while mapped.
+     *
      * \see FileSerializer
 
          \identifier{7t} */
-    FileDeserializer(const std::string& fname);
+    FileDeserializer(const std::string& fname, const Dict& opts=Dict());
     ~FileDeserializer();
   };
 
@@ -37,13 +37,104 @@
 #include "function_internal.hpp"
 #include "fmu_impl.hpp" // Not sure why this is needed and importer_internal.hpp is not
 #include <iomanip>
+#include <fstream>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
 
 namespace casadi {
 
-    static casadi_int serialization_protocol_version = 3;
+    // Version 4: encoding flag (text or binary) added to header
+    // Version 5: Map stores a version and its batch flag
+    static casadi_int serialization_protocol_version = 5;
     static casadi_int serialization_check = 123456789012345;
 
-    DeserializingStream::DeserializingStream(std::istream& in_s) : in(in_s), debug_(false) {
+    SerializedData::SerializedData(std::string&& s) {
+      auto owner = std::make_shared<std::string>(std::move(s));
+      data_ = owner->data();
+      size_ = owner->size();
+      owner_ = owner;
+    }
+
+    SerializedData SerializedData::map_file(const std::string& fname) {
+#ifndef _WIN32
+      int fd = open(fname.c_str(), O_RDONLY);
+      casadi_assert(fd!=-1, "Could not open file '" + fname + "' for reading.");
+      struct stat st;
+      if (fstat(fd, &st)==0 && st.st_size>0) {
+        size_t size = st.st_size;
+        void* addr = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (addr!=MAP_FAILED) {
+          SerializedData ret;
+          ret.owner_ = std::shared_ptr<const void>(addr,
+            [size](const void* a) { munmap(const_cast<void*>(a), size);});
+          ret.data_ = static_cast<const char*>(addr);
+          ret.size_ = size;
+          return ret;
+        }
+      } else {
+        close(fd);
+      }
+#endif // _WIN32
+      // Fall back to reading the file into memory
+      std::ifstream f(fname, std::ios_base::binary | std::ios::in);
+      casadi_assert(f.good(), "Could not open file '" + fname + "' for reading.");
+      std::stringstream ss;
+      ss << f.rdbuf();
+      return SerializedData(ss.str());
+    }
+
+    SerializedData SerializedData::sub(size_t offset, size_t size) const {
+      casadi_assert(offset+size<=size_, "SerializedData: out of bounds.");
+      SerializedData ret;
+      ret.owner_ = owner_;
+      ret.data_ = data_ + offset;
+      ret.size_ = size;
+      return ret;
+    }
+
+    SerializedDataStream::Buffer::Buffer(const SerializedData& d) {
+      char* p = const_cast<char*>(d.data());
+      setg(p, p, p + d.size());
+    }
+
+    SerializedDataStream::Buffer::pos_type SerializedDataStream::Buffer::seekoff(
+        off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) {
+      char* p;
+      if (dir==std::ios_base::beg) {
+        p = eback() + off;
+      } else if (dir==std::ios_base::cur) {
+        p = gptr() + off;
+      } else {
+        p = egptr() + off;
+      }
+      if (p<eback() || p>egptr()) return pos_type(off_type(-1));
+      setg(eback(), p, egptr());
+      return pos_type(p - eback());
+    }
+
+    SerializedDataStream::Buffer::pos_type SerializedDataStream::Buffer::seekpos(
+        pos_type pos, std::ios_base::openmode which) {
+      return seekoff(off_type(pos), std::ios_base::beg, which);
+    }
+
+    SerializedDataStream::SerializedDataStream(const SerializedData& d) :
+        std::istream(nullptr), data_(d), buf_(data_) {
+      rdbuf(&buf_);
+    }
+
+    DeserializingStream::DeserializingStream(std::istream& in_s) :
+      DeserializingStream(in_s, SerializedData()) {
+    }
+
+    DeserializingStream::DeserializingStream(std::istream& in_s, const SerializedData& source) :
+        in(in_s), source_(source), debug_(false), binary_(false),
+        protocol_(serialization_protocol_version) {
 
       casadi_assert(in_s.good(), "Invalid input stream. If you specified an input file, "
         "make sure it exists relative to the current directory.");
@@ -58,15 +149,23 @@ namespace casadi {
       // API version check
       casadi_int v;
       unpack(v);
-      casadi_assert(v==serialization_protocol_version,
+      casadi_assert(v>=3 && v<=serialization_protocol_version,
         "Serialization protocol is not compatible. "
-        "Got version " + str(v) + ", while " +
+        "Got version " + str(v) + ", while 3..." +
         str(serialization_protocol_version) + " was expected.");
 
+      protocol_ = v;
+
+      // Version 3 streams are always text
+      bool binary = false;
+      if (v>=4) unpack(binary);
+
       bool debug;
       unpack(debug);
       debug_ = debug;
 
+      // Remainder of stream in the requested encoding
+      binary_ = binary;
     }
 
     SerializingStream::SerializingStream(std::ostream& out_s) :
@@ -74,25 +173,35 @@ namespace casadi {
     }
 
     SerializingStream::SerializingStream(std::ostream& out_s, const Dict& opts) :
-        out(out_s), debug_(false) {
+        out(out_s), debug_(false), binary_(false), names_(true) {
       // Sanity check
       pack(serialization_check);
       // API version check
       pack(casadi_int(serialization_protocol_version));
 
       bool debug = false;
+      bool binary = false;
 
       // Read options
       for (auto&& op : opts) {
         if (op.first=="debug") {
           debug = op.second;
+        } else if (op.first=="binary") {
+          binary = op.second;
+        } else if (op.first=="names") {
+          // Without names, the stream only identifies the structure
+          names_ = op.second;
         } else {
           casadi_error("Unknown option: '" + op.first + "'.");
         }
       }
 
+      pack(binary);
       pack(debug);
       debug_ = debug;
+
+      // Remainder of stream in the requested encoding
+      binary_ = binary;
     }
 
     void SerializingStream::decorate(char e) {
@@ -107,69 +216,100 @@ namespace casadi {
       }
     }
 
+    void SerializingStream::pack_raw(const void* data, size_t n) {
+      const unsigned char* c = static_cast<const unsigned char*>(data);
+      if (binary_) {
+        out.write(reinterpret_cast<const char*>(c), n);
+      } else {
+        // Two printable characters per byte, written in blocks
+        const unsigned char ref = 'a';
+        char buffer[1024];
+        while (n>0) {
+          size_t m = std::min(n, sizeof(buffer)/2);
+          for (size_t j=0; j<m; ++j) {
+            buffer[2*j] = ref + (c[j] % 16);
+            buffer[2*j+1] = ref + (c[j] >> 4);
+          }
+          out.write(buffer, 2*m);
+          c += m;
+          n -= m;
+        }
+      }
+    }
+
+    void DeserializingStream::unpack_raw(void* data, size_t n) {
+      unsigned char* c = static_cast<unsigned char*>(data);
+      if (binary_) {
+        in.read(reinterpret_cast<char*>(c), n);
+        casadi_assert(static_cast<size_t>(in.gcount())==n,
+          "DeserializingStream: unexpected end of stream.");
+      } else {
+        const unsigned char ref = 'a';
+        char buffer[1024];
+        while (n>0) {
+          size_t m = std::min(n, sizeof(buffer)/2);
+          in.read(buffer, 2*m);
+          for (size_t j=0; j<m; ++j) {
+            c[j] = (static_cast<unsigned char>(buffer[2*j])-ref) +
+                   ((static_cast<unsigned char>(buffer[2*j+1])-ref) << 4);
+          }
+          c += m;
+          n -= m;
+        }
+      }
+    }
+
     void DeserializingStream::unpack(casadi_int& e) {
       assert_decoration('J');
       int64_t n;
-      char* c = reinterpret_cast<char*>(&n);
-
-      for (int j=0;j<8;++j) unpack(c[j]);
+      unpack_raw(&n, sizeof(n));
       e = n;
     }
 
     void SerializingStream::pack(casadi_int e) {
       decorate('J');
       int64_t n = e;
-      const char* c = reinterpret_cast<const char*>(&n);
-      for (int j=0;j<8;++j) pack(c[j]);
+      pack_raw(&n, sizeof(n));
     }
 
     void SerializingStream::pack(size_t e) {
       decorate('K');
       uint64_t n = e;
-      const char* c = reinterpret_cast<const char*>(&n);
-      for (int j=0;j<8;++j) pack(c[j]);
+      pack_raw(&n, sizeof(n));
     }
 
     void DeserializingStream::unpack(size_t& e) {
       assert_decoration('K');
       uint64_t n;
-      char* c = reinterpret_cast<char*>(&n);
-
-      for (int j=0;j<8;++j) unpack(c[j]);
+      unpack_raw(&n, sizeof(n));
       e = n;
     }
 
     void DeserializingStream::unpack(int& e) {
       assert_decoration('i');
       int32_t n;
-      char* c = reinterpret_cast<char*>(&n);
-
-      for (int j=0;j<4;++j) unpack(c[j]);
+      unpack_raw(&n, sizeof(n));
       e = n;
     }
 
     void SerializingStream::pack(int e) {
       decorate('i');
       int32_t n = e;
-      const char* c = reinterpret_cast<const char*>(&n);
-      for (int j=0;j<4;++j) pack(c[j]);
+      pack_raw(&n, sizeof(n));
     }
 
 #if SIZE_MAX != UINT_MAX || defined(__EMSCRIPTEN__)
     void DeserializingStream::unpack(unsigned int& e) {
       assert_decoration('u');
       uint32_t n;
-      char* c = reinterpret_cast<char*>(&n);
-
-      for (int j=0;j<4;++j) unpack(c[j]);
+      unpack_raw(&n, sizeof(n));
       e = n;
     }
 
     void SerializingStream::pack(unsigned int e) {
       decorate('u');
       uint32_t n = e;
-      const char* c = reinterpret_cast<const char*>(&n);
-      for (int j=0;j<4;++j) pack(c[j]);
+      pack_raw(&n, sizeof(n));
     }
 #endif
 
@@ -186,6 +326,10 @@ namespace casadi {
     }
 
     void DeserializingStream::unpack(char& e) {
+      if (binary_) {
+        in.get(e);
+        return;
+      }
       unsigned char ref = 'a';
       in.get(e);
       char t;
@@ -195,6 +339,10 @@ namespace casadi {
     }
 
     void SerializingStream::pack(char e) {
+      if (binary_) {
+        out.put(e);
+        return;
+      }
       unsigned char ref = 'a';
       // Note: outputstreams work neatly with std::hex,
       // but inputstreams don't
@@ -206,8 +354,7 @@ namespace casadi {
       decorate('s');
       int s = static_cast<int>(e.size());
       pack(s);
-      const char* c = e.c_str();
-      for (int j = 0; j < s; ++j) pack(c[j]);
+      pack_raw(e.data(), s);
     }
 
     void DeserializingStream::unpack(std::string& e) {
@@ -215,19 +362,92 @@ namespace casadi {
       int s;
       unpack(s);
       e.resize(s);
-      for (int j=0;j<s;++j) unpack(e[j]);
+      if (s) unpack_raw(&e[0], s);
     }
 
     void DeserializingStream::unpack(double& e) {
       assert_decoration('d');
-      char* c = reinterpret_cast<char*>(&e);
-      for (int j=0;j<8;++j) unpack(c[j]);
+      unpack_raw(&e, sizeof(e));
     }
 
     void SerializingStream::pack(double e) {
       decorate('d');
-      const char* c = reinterpret_cast<const char*>(&e);
-      for (int j=0;j<8;++j) pack(c[j]);
+      pack_raw(&e, sizeof(e));
+    }
+
+    void SerializingStream::pack(const std::vector<double>& e) {
+      pack_bulk(e);
+    }
+
+    void DeserializingStream::unpack(std::vector<double>& e) {
+      unpack_bulk(e);
+    }
+
+    void SerializingStream::pack(const std::vector<casadi_int>& e) {
+      if (sizeof(casadi_int)==sizeof(int64_t)) {
+        pack_bulk(e);
+      } else {
+        decorate('V');
+        pack(static_cast<casadi_int>(e.size()));
+        for (casadi_int i : e) pack(i);
+      }
+    }
+
+    void DeserializingStream::unpack(std::vector<casadi_int>& e) {
+      if (sizeof(casadi_int)==sizeof(int64_t)) {
+        unpack_bulk(e);
+      } else {
+        assert_decoration('V');
+        casadi_int s;
+        unpack(s);
+        e.resize(s);
+        for (casadi_int& i : e) unpack(i);
+      }
+    }
+
+    void SerializingStream::pack(const std::vector<int>& e) {
+      if (sizeof(int)==sizeof(int32_t)) {
+        pack_bulk(e);
+      } else {
+        decorate('V');
+        pack(static_cast<casadi_int>(e.size()));
+        for (int i : e) pack(i);
+      }
+    }
+
+    void DeserializingStream::unpack(std::vector<int>& e) {
+      if (sizeof(int)==sizeof(int32_t)) {
+        unpack_bulk(e);
+      } else {
+        assert_decoration('V');
+        casadi_int s;
+        unpack(s);
+        e.resize(s);
+        for (int& i : e) unpack(i);
+      }
+    }
+
+    void SerializingStream::pack(const SerializedData& e) {
+      decorate('Y');
+      pack(e.size());
+      pack_raw(e.data(), e.size());
+    }
+
+    void DeserializingStream::unpack(SerializedData& e) {
+      assert_decoration('Y');
+      size_t len;
+      unpack(len);
+      if (binary_ && !source_.empty()) {
+        // Refer into source without copying
+        std::streamoff pos = in.tellg();
+        casadi_assert_dev(pos>=0);
+        e = source_.sub(pos, len);
+        in.seekg(len, std::ios_base::cur);
+      } else {
+        std::string s(len, 0);
+        if (len) unpack_raw(&s[0], len);
+        e = SerializedData(std::move(s));
+      }
     }
 
     void SerializingStream::pack(const Sparsity& e) {
@@ -310,9 +530,7 @@ namespace casadi {
       for (size_t i=0;i<len;++i) {
         s.read(buffer, 1024);
         size_t c = s.gcount();
-        for (size_t j=0;j<c;++j) {
-          pack(buffer[j]);
-        }
+        pack_raw(buffer, c);
         if (s.rdstate() & std::ifstream::eofbit) break;
       }
     }
@@ -321,10 +539,12 @@ namespace casadi {
       assert_decoration('B');
       size_t len;
       unpack(len);
-      for (size_t i=0;i<len;++i) {
-        char c;
-        unpack(c);
-        s.put(c);
+      char buffer[1024];
+      while (len>0) {
+        size_t c = std::min(len, sizeof(buffer));
+        unpack_raw(buffer, c);
+        s.write(buffer, c);
+        len -= c;
       }
     }
 
@@ -28,6 +28,7 @@
 
 #include <set>
 #include <sstream>
+#include <memory>
 #include <unordered_map>
 #include <cstdint>
 #include <climits>
@@ -63,6 +64,53 @@ namespace casadi {
   };
   typedef std::map<std::string, GenericType> Dict;
 
+  /** \brief Contiguous block of serialized data
+
+      Either owns its bytes or refers into a block kept alive by a shared owner,
+      e.g. a memory-mapped file. Copies share the underlying bytes.
+  */
+  class CASADI_EXPORT SerializedData {
+  public:
+    /// Empty block
+    SerializedData() : data_(nullptr), size_(0) {}
+
+    /// Take ownership of the contents of a string
+    explicit SerializedData(std::string&& s);
+
+    /// Memory-map a file, or read it into memory where mapping is not available
+    static SerializedData map_file(const std::string& fname);
+
+    /// Sub-block sharing ownership with this block
+    SerializedData sub(size_t offset, size_t size) const;
+
+    const char* data() const { return data_;}
+    size_t size() const { return size_;}
+    bool empty() const { return size_==0;}
+
+  private:
+    std::shared_ptr<const void> owner_;
+    const char* data_;
+    size_t size_;
+  };
+
+  /** \brief Input stream reading from a SerializedData block */
+  class CASADI_EXPORT SerializedDataStream : public std::istream {
+  public:
+    explicit SerializedDataStream(const SerializedData& d);
+  private:
+    class Buffer : public std::streambuf {
+    public:
+      explicit Buffer(const SerializedData& d);
+    protected:
+      pos_type seekoff(off_type off, std::ios_base::seekdir dir,
+        std::ios_base::openmode which) override;
+      pos_type seekpos(pos_type pos, std::ios_base::openmode which) override;
+    };
+    // Keeps the bytes alive
+    SerializedData data_;
+    Buffer buf_;
+  };
+
   /** \brief Helper class for Serialization
 
       \author Joris Gillis
@@ -76,6 +124,13 @@ namespace casadi {
     DeserializingStream(std::istream &in_s);
     DeserializingStream(const DeserializingStream&) = delete;
 
+    /** \brief Construct from a stream reading source from its beginning
+
+        Blocks unpacked as SerializedData then refer into source instead of
+        being copied, when the stream is binary.
+    */
+    DeserializingStream(std::istream &in_s, const SerializedData& source);
+
     //@{
     /** \brief Reconstruct an object from the input stream
     *
@@ -108,6 +163,10 @@ namespace casadi {
     void unpack(std::string& e);
     void unpack(double& e);
     void unpack(char& e);
+    void unpack(std::vector<double>& e);
+    void unpack(std::vector<casadi_int>& e);
+    void unpack(std::vector<int>& e);
+    void unpack(SerializedData& e);
     template <class T>
     void unpack(std::vector<T>& e) {
       assert_decoration('V');
@@ -157,8 +216,37 @@ namespace casadi {
     void connect(SerializingStream & s);
     void reset();
 
+    /// Is the stream in binary mode?
+    bool binary() const { return binary_;}
+
+    /// Is the stream in debug mode?
+    bool debug() const { return debug_;}
+
+    /// Serialization protocol version of the stream
+    casadi_int protocol() const { return protocol_;}
+
   private:
 
+    /** \brief Read raw bytes
+     *
+     * Hex-decoded unless in binary mode
+     */
+    void unpack_raw(void* data, size_t n);
+
+    /// Read a vector of plain data with a single bulk read, if possible
+    template <class T>
+    void unpack_bulk(std::vector<T>& e) {
+      assert_decoration('V');
+      casadi_int s;
+      unpack(s);
+      e.resize(s);
+      if (binary_ && !debug_) {
+        if (s) unpack_raw(e.data(), s*sizeof(T));
+      } else {
+        for (T& i : e) unpack(i);
+      }
+    }
+
     /** \brief Unpacks a shared object
     *
     * Also treats SXNode, which is not actually a SharedObjectInternal
@@ -199,8 +287,14 @@ namespace casadi {
     std::unordered_map<void*, casadi_int>* shared_map_ = nullptr;
     /// Input stream
     std::istream& in;
+    /// Data read by the input stream, if available
+    SerializedData source_;
     /// Debug mode?
     bool debug_;
+    /// Binary mode?
+    bool binary_;
+    /// Protocol version
+    casadi_int protocol_;
   };
 
   /** \brief Helper class for Serialization
@@ -245,6 +339,10 @@ namespace casadi {
     void pack(double e);
     void pack(const std::string& e);
     void pack(char e);
+    void pack(const std::vector<double>& e);
+    void pack(const std::vector<casadi_int>& e);
+    void pack(const std::vector<int>& e);
+    void pack(const SerializedData& e);
     template <class T>
     void pack(const std::vector<T>& e) {
       decorate('V');
@@ -283,7 +381,34 @@ namespace casadi {
     void connect(DeserializingStream & s);
     void reset();
 
+    /// Is the stream in binary mode?
+    bool binary() const { return binary_;}
+
+    /// Is the stream in debug mode?
+    bool debug() const { return debug_;}
+
+    /// Are names of functions, inputs, outputs and symbols stored?
+    bool names() const { return names_;}
+
   private:
+    /** \brief Write raw bytes
+     *
+     * Hex-encoded unless in binary mode
+     */
+    void pack_raw(const void* data, size_t n);
+
+    /// Write a vector of plain data with a single bulk write, if possible
+    template <class T>
+    void pack_bulk(const std::vector<T>& e) {
+      decorate('V');
+      pack(static_cast<casadi_int>(e.size()));
+      if (binary_ && !debug_) {
+        if (!e.empty()) pack_raw(e.data(), e.size()*sizeof(T));
+      } else {
+        for (auto&& i : e) pack(i);
+      }
+    }
+
     /** \brief Insert information for a primitive typecheck during deserialization
      *
      * No-op unless in debug mode
@@ -319,6 +444,10 @@ namespace casadi {
     std::ostream& out;
     /// Debug mode?
     bool debug_;
+    /// Binary mode?
+    bool binary_;
+    /// Store names?
+    bool names_;
   };
 
   template <>
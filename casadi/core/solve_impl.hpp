@@ -254,7 +254,7 @@ namespace casadi {
 
   template<bool Tr>
   size_t LinsolCall<Tr>::sz_w() const {
-    return this->sparsity().size1();
+    return std::max(static_cast<size_t>(this->sparsity().size1()), linsol_->generate_sz_w());
   }
 
   template<bool Tr>
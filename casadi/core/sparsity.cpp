@@ -520,11 +520,33 @@ namespace casadi {
     }
   }
 
-  Sparsity::CachingMap& Sparsity::getCache() {
-    static CachingMap ret;
-    return ret;
+  // Number of shards of the sparsity pattern cache
+  static const std::size_t sparsity_cache_shards = 64;
+
+  // One shard of the cache, on its own cache line
+  struct alignas(64) SparsityCacheShard {
+    Sparsity::CachingMap map;
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::mutex mtx;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+  };
+
+  static SparsityCacheShard& sparsity_cache_shard(std::size_t h) {
+    static SparsityCacheShard shards[sparsity_cache_shards];
+    // Mix in the high bits, the low bits also select the bucket within a shard
+    return shards[(h ^ (h >> 17) ^ (h >> 37)) % sparsity_cache_shards];
+  }
+
+  Sparsity::CachingMap& Sparsity::getCache(std::size_t h) {
+    return sparsity_cache_shard(h).map;
   }
 
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+  std::mutex& Sparsity::cachingmap_mtx(std::size_t h) {
+    return sparsity_cache_shard(h).mtx;
+  }
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+
   const Sparsity& Sparsity::getScalar() {
     static ScalarSparsity ret;
     return ret;
@@ -745,11 +767,12 @@ namespace casadi {
     (*this)->get_nz(indices);
   }
 
-  Sparsity Sparsity::uni_coloring(const Sparsity& AT, casadi_int cutoff) const {
+  Sparsity Sparsity::uni_coloring(const Sparsity& AT, casadi_int cutoff,
+      casadi_int ordering) const {
     if (AT.is_null()) {
-      return (*this)->uni_coloring(T(), cutoff);
+      return (*this)->uni_coloring(T(), cutoff, ordering);
     } else {
-      return (*this)->uni_coloring(AT, cutoff);
+      return (*this)->uni_coloring(AT, cutoff, ordering);
     }
   }
 
@@ -873,12 +896,12 @@ namespace casadi {
     std::size_t h = hash_sparsity(nrow, ncol, colind, row);
 
 #ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
-    // Safe access to CachingMap
-    std::lock_guard<std::mutex> lock(cachingmap_mtx);
+    // Safe access to the shard of the CachingMap, other shards remain available
+    std::lock_guard<std::mutex> lock(cachingmap_mtx(h));
 #endif // CASADI_WITH_THREADSAFE_SYMBOLICS
 
-    // Get a reference to the cache
-    CachingMap& cache = getCache();
+    // Get a reference to the shard of the cache
+    CachingMap& cache = getCache(h);
 
     // Record the current number of buckets (for garbage collection below)
     casadi_int bucket_count_before = cache.bucket_count();
@@ -959,6 +982,7 @@ namespace casadi {
     casadi_int bucket_count_after = cache.bucket_count();
 
     // We we increased the number of buckets, take time to garbage-collect deleted references
+    // Only this shard is swept, amortized over the insertions that grew it
     if (bucket_count_before!=bucket_count_after) {
       CachingMap::const_iterator i=cache.begin();
       while (i!=cache.end()) {
@@ -971,10 +995,6 @@ namespace casadi {
     }
   }
 
-#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
-  std::mutex Sparsity::cachingmap_mtx;
-#endif //CASADI_WITH_THREADSAFE_SYMBOLICS
-
   Sparsity Sparsity::tril(const Sparsity& x, bool includeDiagonal) {
     return x->_tril(includeDiagonal);
   }
@@ -880,12 +880,15 @@ namespace casadi {
 #ifndef SWIG
     typedef std::unordered_multimap<std::size_t, WeakRef> CachingMap;
 
-    /// Cached sparsity patterns
-    static CachingMap& getCache();
+    /** \brief Cached sparsity patterns with hash h
+
+        The cache is split into shards by hash, each with its own lock, so that
+        patterns can be created concurrently. */
+    static CachingMap& getCache(std::size_t h);
 
 #ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
-    // Safe access to CachingMap
-    static std::mutex cachingmap_mtx;
+    // Safe access to the shard of the CachingMap with hash h
+    static std::mutex& cachingmap_mtx(std::size_t h);
 #endif //CASADI_WITH_THREADSAFE_SYMBOLICS
 
     /// (Dense) scalar
@@ -1043,9 +1046,13 @@ namespace casadi {
 
         (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN)
 
+        Ordering options: None (0), largest first (1), smallest last (2),
+        incidence degree (3)
+
         \identifier{db} */
     Sparsity uni_coloring(const Sparsity& AT=Sparsity(),
-                          casadi_int cutoff = std::numeric_limits<casadi_int>::max()) const;
+                          casadi_int cutoff = std::numeric_limits<casadi_int>::max(),
+                          casadi_int ordering = 0) const;
 
     /** \brief Perform a star coloring of a symmetric matrix:
 
@@ -1055,7 +1062,8 @@ namespace casadi {
           A. H. GEBREMEDHIN, F. MANNE, A. POTHEN
           SIAM Rev., 47(4), 629–705 (2006)
 
-        Ordering options: None (0), largest first (1)
+        Ordering options: None (0), largest first (1), smallest last (2),
+        incidence degree (3)
 
         \identifier{dc} */
     Sparsity star_coloring(casadi_int ordering = 1,
@@ -1069,7 +1077,8 @@ namespace casadi {
           A. H. GEBREMEDHIN, A. TARAFDAR, F. MANNE, A. POTHEN
           SIAM J. SCI. COMPUT. Vol. 29, No. 3, pp. 1042–1072 (2007)
 
-        Ordering options: None (0), largest first (1)
+        Ordering options: None (0), largest first (1), smallest last (2),
+        incidence degree (3)
 
         \identifier{dd} */
     Sparsity star_coloring2(casadi_int ordering = 1,
@@ -0,0 +1,132 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sparsity_database.hpp"
+#include "casadi_misc.hpp"
+#include "casadi_meta.hpp"
+#include "casadi_os.hpp"
+#include "serializing_stream.hpp"
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <sys/stat.h>
+#include <sys/types.h>
+#ifdef _WIN32
+#include <direct.h>
+#endif // _WIN32
+
+namespace casadi {
+
+  // File name prefix of all entries
+  static const char* sparsity_database_prefix = "casadi_sp_";
+
+  // 64-bit FNV-1a hash with a given offset basis, stable across platforms and runs
+  static std::string sparsity_database_hash(const std::string& s, uint64_t h) {
+    for (unsigned char c : s) {
+      h ^= c;
+      h *= 1099511628211ULL;
+    }
+    std::stringstream ss;
+    ss << std::hex;
+    ss.width(16);
+    ss.fill('0');
+    ss << h;
+    return ss.str();
+  }
+
+  SparsityDatabase::SparsityDatabase(const std::string& directory) : directory_(directory) {
+    casadi_assert(!directory_.empty(), "Sparsity database directory must be nonempty");
+    char last = directory_.back();
+    if (last != '/' && last != '\\') directory_ += filesep();
+    // Create directory, put() skips entries that cannot be written
+#ifdef _WIN32
+    _mkdir(directory_.c_str());
+#else // _WIN32
+    mkdir(directory_.c_str(), 0755);
+#endif // _WIN32
+  }
+
+  bool SparsityDatabase::get(const std::string& key, std::vector<Sparsity>& sp) const {
+    std::string base = directory_ + sparsity_database_prefix
+      + sparsity_database_hash(key, 14695981039346656037ULL);
+    std::ifstream f(base + ".casadi", std::ios_base::binary);
+    if (!f.good()) return false;
+    try {
+      DeserializingStream s(f);
+      std::string version, check;
+      s.unpack("SparsityDatabase::version", version);
+      s.unpack("SparsityDatabase::check", check);
+      if (version != CasadiMeta::version()) return false;
+      if (check != sparsity_database_hash(key, 0x84222325cbf29ce4ULL)) return false;
+      s.unpack("SparsityDatabase::sp", sp);
+    } catch (std::exception&) {
+      // Truncated or foreign file, treat as missing
+      return false;
+    }
+    return true;
+  }
+
+  void SparsityDatabase::put(const std::string& key, const std::vector<Sparsity>& sp) const {
+    std::string base = directory_ + sparsity_database_prefix
+      + sparsity_database_hash(key, 14695981039346656037ULL);
+    // Write to a temporary file, renaming makes the entry appear atomically
+    std::string tmp;
+    try {
+      tmp = temporary_file(base, ".tmp");
+    } catch (std::exception&) {
+      // Directory missing or not writable, skip caching
+      return;
+    }
+    bool ok = false;
+    {
+      std::ofstream f(tmp, std::ios_base::binary);
+      try {
+        if (f.good()) {
+          SerializingStream s(f, {{"binary", true}});
+          s.pack("SparsityDatabase::version", std::string(CasadiMeta::version()));
+          s.pack("SparsityDatabase::check",
+            sparsity_database_hash(key, 0x84222325cbf29ce4ULL));
+          s.pack("SparsityDatabase::sp", sp);
+          ok = f.good();
+        }
+      } catch (std::exception&) {
+        ok = false;
+      }
+    }
+    if (!ok) {
+      std::remove(tmp.c_str());
+      return;
+    }
+    std::string fname = base + ".casadi";
+    if (std::rename(tmp.c_str(), fname.c_str()) != 0) {
+      // Windows does not replace existing files
+      std::remove(fname.c_str());
+      if (std::rename(tmp.c_str(), fname.c_str()) != 0) std::remove(tmp.c_str());
+    }
+  }
+
+} // namespace casadi
@@ -0,0 +1,70 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_SPARSITY_DATABASE_HPP
+#define CASADI_SPARSITY_DATABASE_HPP
+
+#include "sparsity.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Persistent on-disk store of sparsity patterns
+
+      Jacobian sparsity patterns and colorings are stored under a hash of a
+      structural key, typically the serialized function together with the
+      block that was requested. Structurally identical functions, in the same
+      or in another process, then skip the sparsity propagation sweeps.
+
+      A second, independent hash of the key is stored with each entry and
+      compared on lookup to guard against collisions. Entries are written to
+      a temporary file and renamed, so concurrent writers do not corrupt the
+      store.
+  */
+  class CASADI_EXPORT SparsityDatabase {
+  public:
+    /** \brief Constructor
+
+        \param directory  Location of the store, created if missing
+    */
+    explicit SparsityDatabase(const std::string& directory);
+
+    /** \brief Look up the patterns stored for a key, false if missing */
+    bool get(const std::string& key, std::vector<Sparsity>& sp) const;
+
+    /** \brief Store patterns for a key, null patterns allowed */
+    void put(const std::string& key, const std::vector<Sparsity>& sp) const;
+
+  private:
+    // Directory, ending with a file separator
+    std::string directory_;
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SPARSITY_DATABASE_HPP
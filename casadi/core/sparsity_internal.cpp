@@ -2948,12 +2948,17 @@ namespace casadi {
     std::fill(it, indices.end(), -1);
   }
 
-  Sparsity SparsityInternal::uni_coloring(const Sparsity& AT, casadi_int cutoff) const {
+  Sparsity SparsityInternal::uni_coloring(const Sparsity& AT, casadi_int cutoff,
+      casadi_int ordering) const {
+
+    // Order in which the columns are colored
+    std::vector<casadi_int> ord;
+    if (ordering!=0) ord = coloring_ordering(ordering, AT);
 
     // Allocate temporary vectors
     std::vector<casadi_int> forbiddenColors;
     forbiddenColors.reserve(size2());
-    std::vector<casadi_int> color(size2(), 0);
+    std::vector<casadi_int> color(size2(), -1);
 
     // Access the sparsity of the transpose
     const casadi_int* AT_colind = AT.colind();
@@ -2962,7 +2967,8 @@ namespace casadi {
     const casadi_int* row = this->row();
 
     // Loop over columns
-    for (casadi_int i=0; i<size2(); ++i) {
+    for (casadi_int k=0; k<size2(); ++k) {
+      casadi_int i = ord.empty() ? k : ord[k];
 
       // Loop over nonzero elements
       for (casadi_int el=colind[i]; el<colind[i+1]; ++el) {
@@ -2977,11 +2983,12 @@ namespace casadi {
           casadi_int i_prev = AT_row[el_prev];
 
           // Escape loop if we have arrived at the current col
-          if (i_prev>=i)
+          if (ord.empty() && i_prev>=i)
             break;
 
-          // Get the color of the col
+          // Get the color of the col, skip if not yet colored
           casadi_int color_prev = color[i_prev];
+          if (color_prev<0) continue;
 
           // Mark the color as forbidden for the current col
           forbiddenColors[color_prev] = i;
@@ -2998,7 +3005,7 @@ namespace casadi {
 
       // Add color if reached end
       if (color_i==forbiddenColors.size()) {
-        forbiddenColors.push_back(0);
+        forbiddenColors.push_back(-1);
 
         // Cutoff if too many colors
         if (forbiddenColors.size()>cutoff) {
@@ -3048,16 +3055,15 @@ namespace casadi {
     const casadi_int* colind = this->colind();
     const casadi_int* row = this->row();
     if (ordering!=0) {
-      casadi_assert_dev(ordering==1);
-
       // Ordering
-      std::vector<casadi_int> ord = largest_first();
+      std::vector<casadi_int> ord = coloring_ordering(ordering);
 
       // Create a new sparsity pattern
       Sparsity sp_permuted = pmult(ord, true, true, true);
 
       // Star coloring for the permuted matrix
-      Sparsity ret_permuted = sp_permuted.star_coloring2(0);
+      Sparsity ret_permuted = sp_permuted.star_coloring2(0, cutoff);
+      if (ret_permuted.is_null()) return ret_permuted;
 
       // Permute result back
       return ret_permuted.pmult(ord, true, false, false);
@@ -3298,16 +3304,15 @@ namespace casadi {
 
     // Reorder, if necessary
     if (ordering!=0) {
-      casadi_assert_dev(ordering==1);
-
       // Ordering
-      std::vector<casadi_int> ord = largest_first();
+      std::vector<casadi_int> ord = coloring_ordering(ordering);
 
       // Create a new sparsity pattern
       Sparsity sp_permuted = pmult(ord, true, true, true);
 
       // Star coloring for the permuted matrix
-      Sparsity ret_permuted = sp_permuted.star_coloring(0);
+      Sparsity ret_permuted = sp_permuted.star_coloring(0, cutoff);
+      if (ret_permuted.is_null()) return ret_permuted;
 
       // Permute result back
       return ret_permuted.pmult(ord, true, false, false);
@@ -3438,6 +3443,124 @@ namespace casadi {
     return reverse_ordering;
   }
 
+  // Visit the neighbors of column j, distance-2 via AT if given, with multiplicity
+  template<typename F>
+  static void coloring_neighbors(const casadi_int* colind, const casadi_int* row,
+      const casadi_int* AT_colind, const casadi_int* AT_row, casadi_int j, F f) {
+    for (casadi_int el=colind[j]; el<colind[j+1]; ++el) {
+      casadi_int r = row[el];
+      if (AT_colind) {
+        for (casadi_int k=AT_colind[r]; k<AT_colind[r+1]; ++k) {
+          if (AT_row[k]!=j) f(AT_row[k]);
+        }
+      } else if (r!=j) {
+        f(r);
+      }
+    }
+  }
+
+  // Vertices grouped by degree in doubly linked lists
+  struct ColoringBuckets {
+    std::vector<casadi_int> head, next, prev, deg;
+    ColoringBuckets(casadi_int n, casadi_int max_deg)
+      : head(max_deg+1, -1), next(n, -1), prev(n, -1), deg(n, 0) {}
+    void insert(casadi_int v) {
+      casadi_int& h = head[deg[v]];
+      prev[v] = -1;
+      next[v] = h;
+      if (h>=0) prev[h] = v;
+      h = v;
+    }
+    void remove(casadi_int v) {
+      if (prev[v]>=0) {
+        next[prev[v]] = next[v];
+      } else {
+        head[deg[v]] = next[v];
+      }
+      if (next[v]>=0) prev[next[v]] = prev[v];
+    }
+  };
+
+  std::vector<casadi_int> SparsityInternal::coloring_ordering(casadi_int ordering,
+      const Sparsity& AT) const {
+    casadi_int n = size2();
+    casadi_assert(ordering>=0 && ordering<=3, "Unknown coloring ordering " + str(ordering));
+
+    // Natural ordering
+    if (ordering==0) return range(n);
+
+    // Degree in the adjacency graph is the column count
+    if (ordering==1 && AT.is_null()) return largest_first();
+
+    // Sparsity pattern
+    const casadi_int *colind = this->colind(), *row = this->row();
+    const casadi_int *AT_colind = AT.is_null() ? nullptr : AT.colind();
+    const casadi_int *AT_row = AT.is_null() ? nullptr : AT.row();
+
+    // Degree of each column
+    std::vector<casadi_int> degree(n, 0);
+    for (casadi_int j=0; j<n; ++j) {
+      casadi_int& d = degree[j];
+      coloring_neighbors(colind, row, AT_colind, AT_row, j, [&d](casadi_int) { d++;});
+    }
+    casadi_int max_deg = n==0 ? 0 : *std::max_element(degree.begin(), degree.end());
+
+    // Return value
+    std::vector<casadi_int> ord(n);
+
+    // Largest first, ties in natural order
+    if (ordering==1) {
+      std::vector<casadi_int> count(max_deg+2, 0);
+      for (casadi_int j=0; j<n; ++j) count[max_deg-degree[j]+1]++;
+      for (casadi_int d=0; d<=max_deg; ++d) count[d+1] += count[d];
+      for (casadi_int j=0; j<n; ++j) ord[count[max_deg-degree[j]]++] = j;
+      return ord;
+    }
+
+    // Columns with natural order at the head of each bucket
+    ColoringBuckets b(n, max_deg);
+    std::vector<bool> done(n, false);
+    if (ordering==2) {
+      // Smallest last: repeatedly remove a column of minimum remaining degree
+      b.deg = degree;
+      for (casadi_int j=n-1; j>=0; --j) b.insert(j);
+      casadi_int min_deg = 0;
+      for (casadi_int k=n-1; k>=0; --k) {
+        while (b.head[min_deg]<0) min_deg++;
+        casadi_int v = b.head[min_deg];
+        b.remove(v);
+        done[v] = true;
+        ord[k] = v;
+        coloring_neighbors(colind, row, AT_colind, AT_row, v, [&](casadi_int u) {
+          if (done[u] || b.deg[u]==0) return;
+          b.remove(u);
+          b.deg[u]--;
+          b.insert(u);
+          min_deg = std::min(min_deg, b.deg[u]);
+        });
+      }
+    } else {
+      // Incidence degree: next is a column with most already ordered neighbors
+      for (casadi_int j=n-1; j>=0; --j) b.insert(j);
+      casadi_int top_deg = 0;
+      for (casadi_int k=0; k<n; ++k) {
+        while (b.head[top_deg]<0) top_deg--;
+        casadi_int v = b.head[top_deg];
+        b.remove(v);
+        done[v] = true;
+        ord[k] = v;
+        coloring_neighbors(colind, row, AT_colind, AT_row, v, [&](casadi_int u) {
+          if (done[u] || b.deg[u]==max_deg) return;
+          b.remove(u);
+          b.deg[u]++;
+          b.insert(u);
+          top_deg = std::max(top_deg, b.deg[u]);
+        });
+      }
+    }
+    return ord;
+  }
+
   Sparsity SparsityInternal::pmult(const std::vector<casadi_int>& p, bool permute_rows,
                                    bool permute_columns, bool invert_permutation) const {
     // Invert p, possibly
@@ -717,7 +717,7 @@ namespace casadi {
      * (Algorithm 3.1 in A. H. GEBREMEDHIN, F. MANNE, A. POTHEN)
 
         \identifier{fn} */
-    Sparsity uni_coloring(const Sparsity& AT, casadi_int cutoff) const;
+    Sparsity uni_coloring(const Sparsity& AT, casadi_int cutoff, casadi_int ordering=0) const;
 
     /** \brief A greedy distance-2 coloring algorithm
 
@@ -736,6 +736,16 @@ namespace casadi {
     /// Order the columns by decreasing degree
     std::vector<casadi_int> largest_first() const;
 
+    /** \brief Order the columns for greedy coloring
+
+     * Ordering options: None (0), largest first (1), smallest last (2),
+     * incidence degree (3). Degrees refer to the column intersection graph
+     * if AT is given, counting shared rows with multiplicity, else to the
+     * adjacency graph of the symmetric pattern.
+     */
+    std::vector<casadi_int> coloring_ordering(casadi_int ordering,
+      const Sparsity& AT=Sparsity()) const;
+
     /// Permute rows and/or columns
     Sparsity pmult(const std::vector<casadi_int>& p, bool permute_rows=true, bool permute_cols=true,
                    bool invert_permutation=false) const;
@@ -24,6 +24,8 @@
 
 
 #include "sx_function.hpp"
+#include "native_code.hpp"
+#include "sx_tape.hpp"
 #include <limits>
 #include <stack>
 #include <deque>
@@ -62,10 +64,13 @@ namespace casadi {
     // Default (persistent) options
     just_in_time_opencl_ = false;
     just_in_time_sparsity_ = false;
+    native_code_ = nullptr;
+    numeric_ad_ = false;
   }
 
   SXFunction::~SXFunction() {
     clear_mem();
+    delete native_code_;
   }
 
   int SXFunction::eval(const double** arg, double** res,
@@ -80,6 +85,15 @@ namespace casadi {
                    + str(free_vars_) + " are free.");
     }
 
+    // In-process machine code
+    if (native_code_) {
+      (*native_code_)(arg, res, w);
+      return 0;
+    }
+
+    // Threaded bytecode interpreter
+    if (bytecode_) return eval_bytecode(arg, res, iw, w);
+
     // NOTE: The implementation of this function is very delicate. Small changes in the
     // class structure can cause large performance losses. For this reason,
     // the preprocessor macros are used below
@@ -102,6 +116,310 @@ namespace casadi {
     return 0;
   }
 
+  // Interpreter opcodes, BC_GENERIC dispatches on the CasADi operation
+  enum BytecodeOp : unsigned char {
+    BC_CONST, BC_INPUT, BC_OUTPUT, BC_CALL,
+    BC_ADD, BC_SUB, BC_MUL, BC_DIV, BC_NEG, BC_SQ, BC_TWICE,
+    BC_SIN, BC_COS, BC_EXP, BC_LOG, BC_SQRT, BC_GENERIC,
+    // Superinstructions spanning two entries
+    BC_MUL_ADD, BC_ADD_C, BC_SUB_C, BC_MUL_C, BC_DIV_C,
+    // Sentinel
+    BC_END
+  };
+
+  // Opcode of an operation without fusion
+  static BytecodeOp bytecode_op(casadi_int op) {
+    switch (op) {
+      case OP_CONST: return BC_CONST;
+      case OP_INPUT: return BC_INPUT;
+      case OP_OUTPUT: return BC_OUTPUT;
+      case OP_CALL: return BC_CALL;
+      case OP_ADD: return BC_ADD;
+      case OP_SUB: return BC_SUB;
+      case OP_MUL: return BC_MUL;
+      case OP_DIV: return BC_DIV;
+      case OP_NEG: return BC_NEG;
+      case OP_SQ: return BC_SQ;
+      case OP_TWICE: return BC_TWICE;
+      case OP_SIN: return BC_SIN;
+      case OP_COS: return BC_COS;
+      case OP_EXP: return BC_EXP;
+      case OP_LOG: return BC_LOG;
+      case OP_SQRT: return BC_SQRT;
+      default: return BC_GENERIC;
+    }
+  }
+
+  void SXFunction::init_bytecode() {
+    bc_ = Bytecode();
+    if (!bytecode_) return;
+    casadi_assert_dev(NUM_BUILT_IN_OPS <= 256);
+
+    // One entry per algorithm element plus sentinel
+    casadi_int n = algorithm_.size();
+    bc_.op.resize(n+1, BC_END);
+    bc_.fop.resize(n+1, 0);
+    bc_.i0.resize(n+1, 0);
+    bc_.i1.resize(n+1, 0);
+    bc_.i2.resize(n+1, 0);
+
+    for (casadi_int k=0; k<n; ++k) {
+      const AlgEl& e = algorithm_[k];
+      bc_.fop[k] = static_cast<unsigned char>(e.op);
+      bc_.i0[k] = e.i0;
+      if (e.op==OP_CONST) {
+        bc_.op[k] = BC_CONST;
+        bc_.i1[k] = bc_.c.size();
+        bc_.c.push_back(e.d);
+      } else if (e.op==OP_CALL) {
+        // Call nodes keep their algorithm element
+        bc_.op[k] = BC_CALL;
+        bc_.i1[k] = k;
+      } else {
+        bc_.op[k] = bytecode_op(e.op);
+        bc_.i1[k] = e.i1;
+        bc_.i2[k] = e.i2;
+      }
+      if (k+1==n) break;
+      const AlgEl& e2 = algorithm_[k+1];
+      if (e.op==OP_CONST) {
+        // Binary operation with a constant operand: w[i0] = w[i1] op c
+        BytecodeOp f = BC_END;
+        int x = -1;
+        bool commutative = e2.op==OP_ADD || e2.op==OP_MUL;
+        if (e2.op==OP_ADD || e2.op==OP_SUB || e2.op==OP_MUL || e2.op==OP_DIV) {
+          if (e2.i2==e.i0) {
+            x = e2.i1;
+          } else if (commutative && e2.i1==e.i0) {
+            x = e2.i2;
+          }
+        }
+        if (x>=0) {
+          switch (e2.op) {
+            case OP_ADD: f = BC_ADD_C; break;
+            case OP_SUB: f = BC_SUB_C; break;
+            case OP_MUL: f = BC_MUL_C; break;
+            case OP_DIV: f = BC_DIV_C; break;
+          }
+          bc_.op[k] = bc_.op[k+1] = f;
+          bc_.i2[k] = e.i0;
+          bc_.i0[k+1] = e2.i0;
+          bc_.i1[k+1] = x;
+          bc_.fop[k+1] = static_cast<unsigned char>(e2.op);
+          k++;
+        }
+      } else if (e.op==OP_MUL && e2.op==OP_ADD && (e2.i1==e.i0 || e2.i2==e.i0)) {
+        // Multiply-add: w[i0] = w[i1]*w[i2], then w[i0'] = w[i0] + w[i1']
+        bc_.op[k] = bc_.op[k+1] = BC_MUL_ADD;
+        bc_.i0[k+1] = e2.i0;
+        bc_.i1[k+1] = e2.i1==e.i0 ? e2.i2 : e2.i1;
+        bc_.fop[k+1] = static_cast<unsigned char>(e2.op);
+        k++;
+      }
+    }
+  }
+
+  void SXFunction::init_native() {
+    delete native_code_;
+    native_code_ = nullptr;
+    if (!native_) return;
+    if (!NativeCode::available()) {
+      casadi_warning(name_ + ": Native code is not available on this host, "
+                     "falling back to the interpreter.");
+    } else if (!NativeCode::supported(algorithm_)) {
+      casadi_warning(name_ + ": Native code does not support calls or free variables, "
+                     "falling back to the interpreter.");
+    } else {
+      try {
+        native_code_ = new NativeCode(algorithm_);
+      } catch (std::exception& e) {
+        // E.g. the host forbids making writable memory executable
+        casadi_warning(name_ + ": Native code could not be loaded, "
+                       "falling back to the interpreter. " + std::string(e.what()));
+        return;
+      }
+      if (verbose_) casadi_message(name_ + ": emitted " + str(native_code_->size())
+                                   + " bytes of native code");
+    }
+  }
+
+// Direct threading with computed goto where supported, switch dispatch otherwise
+#if defined(__GNUC__) && !defined(CASADI_BYTECODE_SWITCH)
+#define CASADI_BC_THREADED
+#define CASADI_BC_TARGET(NAME) L_ ## NAME:
+#define CASADI_BC_DISPATCH goto *target[op[k]];
+#else
+#define CASADI_BC_TARGET(NAME) case NAME:
+#define CASADI_BC_DISPATCH continue;
+#endif
+#define CASADI_BC_NEXT(N) { k += N; CASADI_BC_DISPATCH }
+
+  int SXFunction::eval_bytecode(const double** arg, double** res,
+      casadi_int* iw, double* w) const {
+    // Instruction stream
+    const unsigned char* op = get_ptr(bc_.op);
+    const unsigned char* fop = get_ptr(bc_.fop);
+    const int* i0 = get_ptr(bc_.i0);
+    const int* i1 = get_ptr(bc_.i1);
+    const int* i2 = get_ptr(bc_.i2);
+    const double* c = get_ptr(bc_.c);
+    casadi_int k = 0;
+    double t;
+
+#ifdef CASADI_BC_THREADED
+    // Jump table, in the order of BytecodeOp
+    static const void* const target[] = {
+      &&L_BC_CONST, &&L_BC_INPUT, &&L_BC_OUTPUT, &&L_BC_CALL,
+      &&L_BC_ADD, &&L_BC_SUB, &&L_BC_MUL, &&L_BC_DIV, &&L_BC_NEG, &&L_BC_SQ, &&L_BC_TWICE,
+      &&L_BC_SIN, &&L_BC_COS, &&L_BC_EXP, &&L_BC_LOG, &&L_BC_SQRT, &&L_BC_GENERIC,
+      &&L_BC_MUL_ADD, &&L_BC_ADD_C, &&L_BC_SUB_C, &&L_BC_MUL_C, &&L_BC_DIV_C,
+      &&L_BC_END};
+    CASADI_BC_DISPATCH
+    {
+#else
+    for (;;) {
+      switch (op[k]) {
+#endif
+      CASADI_BC_TARGET(BC_CONST)
+        w[i0[k]] = c[i1[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_INPUT)
+        w[i0[k]] = arg[i1[k]]==nullptr ? 0 : arg[i1[k]][i2[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_OUTPUT)
+        if (res[i0[k]]!=nullptr) res[i0[k]][i2[k]] = w[i1[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_CALL)
+        call_fwd(algorithm_[i1[k]], arg, res, iw, w);
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_ADD)
+        w[i0[k]] = w[i1[k]] + w[i2[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_SUB)
+        w[i0[k]] = w[i1[k]] - w[i2[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_MUL)
+        w[i0[k]] = w[i1[k]] * w[i2[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_DIV)
+        w[i0[k]] = w[i1[k]] / w[i2[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_NEG)
+        w[i0[k]] = -w[i1[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_SQ)
+        w[i0[k]] = w[i1[k]] * w[i1[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_TWICE)
+        w[i0[k]] = 2. * w[i1[k]];
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_SIN)
+        w[i0[k]] = sin(w[i1[k]]);
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_COS)
+        w[i0[k]] = cos(w[i1[k]]);
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_EXP)
+        w[i0[k]] = exp(w[i1[k]]);
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_LOG)
+        w[i0[k]] = log(w[i1[k]]);
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_SQRT)
+        w[i0[k]] = sqrt(w[i1[k]]);
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_GENERIC)
+        casadi_math<double>::fun(fop[k], w[i1[k]], w[i2[k]], w[i0[k]]);
+        CASADI_BC_NEXT(1)
+      CASADI_BC_TARGET(BC_MUL_ADD)
+        // Product is stored, it may have other uses
+        t = w[i1[k]] * w[i2[k]];
+        w[i0[k]] = t;
+        w[i0[k+1]] = t + w[i1[k+1]];
+        CASADI_BC_NEXT(2)
+      CASADI_BC_TARGET(BC_ADD_C)
+        // Constant is stored, it may have other uses
+        w[i2[k]] = c[i1[k]];
+        w[i0[k+1]] = w[i1[k+1]] + c[i1[k]];
+        CASADI_BC_NEXT(2)
+      CASADI_BC_TARGET(BC_SUB_C)
+        w[i2[k]] = c[i1[k]];
+        w[i0[k+1]] = w[i1[k+1]] - c[i1[k]];
+        CASADI_BC_NEXT(2)
+      CASADI_BC_TARGET(BC_MUL_C)
+        w[i2[k]] = c[i1[k]];
+        w[i0[k+1]] = w[i1[k+1]] * c[i1[k]];
+        CASADI_BC_NEXT(2)
+      CASADI_BC_TARGET(BC_DIV_C)
+        w[i2[k]] = c[i1[k]];
+        w[i0[k+1]] = w[i1[k+1]] / c[i1[k]];
+        CASADI_BC_NEXT(2)
+      CASADI_BC_TARGET(BC_END)
+        return 0;
+#ifdef CASADI_BC_THREADED
+    }
+#else
+      }
+    }
+#endif
+    return 0;
+  }
+
+#undef CASADI_BC_THREADED
+#undef CASADI_BC_TARGET
+#undef CASADI_BC_DISPATCH
+#undef CASADI_BC_NEXT
+
+  bool SXFunction::has_eval_batch() const {
+    // Calls to other functions and JIT compiled code are evaluated point by point
+    return call_.el.empty() && free_vars_.empty() && eval_==nullptr;
+  }
+
+  int SXFunction::eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem, casadi_int n) const {
+    if (verbose_) casadi_message(name_ + "::eval_batch");
+    casadi_assert_dev(has_eval_batch());
+
+    // Lanes per work vector entry
+    const casadi_int L = batch_size;
+
+    // Loop over groups of points
+    for (casadi_int k=0; k<n; k+=L) {
+      // Number of points in this group, remaining lanes are computed but ignored
+      casadi_int n_lane = std::min(L, n-k);
+
+      // Evaluate the algorithm
+      for (auto&& e : algorithm_) {
+        switch (e.op) {
+          CASADI_MATH_FUN_BUILTIN_GEN(BinaryOperationVV, w+e.i1*L, w+e.i2*L, w+e.i0*L, L)
+
+        case OP_CONST: std::fill_n(w+e.i0*L, L, e.d); break;
+        case OP_INPUT:
+          {
+            double* f = w+e.i0*L;
+            std::fill_n(f, L, 0.);
+            if (arg[e.i1]==nullptr) break;
+            casadi_int s = nnz_in(e.i1);
+            const double* a = arg[e.i1] + k*s + e.i2;
+            for (casadi_int j=0; j<n_lane; ++j) f[j] = a[j*s];
+          }
+          break;
+        case OP_OUTPUT:
+          if (res[e.i0]!=nullptr) {
+            const double* f = w+e.i1*L;
+            casadi_int s = nnz_out(e.i0);
+            double* r = res[e.i0] + k*s + e.i2;
+            for (casadi_int j=0; j<n_lane; ++j) r[j*s] = f[j];
+          }
+          break;
+        default:
+          casadi_error("Unknown operation" + str(e.op));
+        }
+      }
+    }
+    return 0;
+  }
+
   bool SXFunction::is_smooth() const {
     // Go through all nodes and check if any node is non-smooth
     for (auto&& a : algorithm_) {
@@ -185,10 +503,22 @@ namespace casadi {
   }
 
   size_t SXFunction::codegen_sz_w(const CodeGenerator& g) const {
-    if (!g.avoid_stack()) return call_.sz_w+call_.sz_w_arg+call_.sz_w_res;
+    if (!g.avoid_stack() && codegen_n_part(g)==1) {
+      return call_.sz_w+call_.sz_w_arg+call_.sz_w_res;
+    }
     return sz_w();
   }
 
+  casadi_int SXFunction::codegen_n_part(const CodeGenerator& g) const {
+    casadi_int n_alg = algorithm_.size();
+    if (g.unit_size==0 || n_alg<=g.unit_size) return 1;
+    return (n_alg+g.unit_size-1)/g.unit_size;
+  }
+
+  std::string SXFunction::codegen_part_name(CodeGenerator& g, casadi_int k) const {
+    return g.shorthand(g.wrapper(self(), "sxpart") + "_" + str(k));
+  }
+
   void SXFunction::codegen_declarations(CodeGenerator& g) const {
 
     // Make sure that there are no free variables
@@ -201,21 +531,59 @@ namespace casadi {
     for (auto&& m : call_.el) {
       g.add_dependency(m.f);
     }
+
+    // Parts of a long algorithm, each a separate function
+    casadi_int n_part = codegen_n_part(g);
+    if (n_part>1) {
+      casadi_int n_alg = algorithm_.size();
+      casadi_int part_size = (n_alg+n_part-1)/n_part;
+      for (casadi_int k=0; k<n_part; ++k) {
+        std::string pname = codegen_part_name(g, k);
+        g.unit_begin();
+        g << "/* Part " << k << " of " << definition() << " */\n";
+        g << signature(pname) << " {\n";
+        g.flush(g.body);
+        g.scope_enter();
+        codegen_algorithm(g, k*part_size, std::min((k+1)*part_size, n_alg), true);
+        g.scope_exit();
+        g << "return 0;\n";
+        g << "}\n\n";
+        g.flush(g.body);
+        g.unit_end(pname, signature(pname));
+      }
+    }
   }
 
   void SXFunction::codegen_body(CodeGenerator& g) const {
-    g.reserve_work(worksize_);
+    casadi_int n_part = codegen_n_part(g);
+    if (n_part>1) {
+      // Work is passed between the parts in w
+      for (casadi_int k=0; k<n_part; ++k) {
+        g << "if (" << codegen_part_name(g, k) << "(arg, res, iw, w, mem)) return 1;\n";
+      }
+    } else {
+      g.reserve_work(worksize_);
+      codegen_algorithm(g, 0, algorithm_.size(), g.avoid_stack());
+    }
+  }
+
+  void SXFunction::codegen_algorithm(CodeGenerator& g, casadi_int begin, casadi_int end,
+      bool in_w) const {
+    // Work vector element, local variable or entry of w
+    auto work = [&](casadi_int i) {
+      return in_w ? "w[" + str(i) + "]" : g.sx_work(i);
+    };
 
-    casadi_int k=0;
     // Run the algorithm
-    for (auto&& a : algorithm_) {
+    for (casadi_int k=begin; k<end; ++k) {
+      const AlgEl& a = algorithm_[k];
       if (a.op==OP_OUTPUT) {
         g << "if (res[" << a.i0 << "]!=0) "
-          << g.res(a.i0) << "[" << a.i2 << "]=" << g.sx_work(a.i1) << ";\n";
+          << g.res(a.i0) << "[" << a.i2 << "]=" << work(a.i1) << ";\n";
       } else if (a.op==OP_CALL) {
         const ExtendedAlgEl& m = call_.el[a.i1];
 
-        casadi_int worksize = g.avoid_stack() ? worksize_ : 0;
+        casadi_int worksize = in_w ? worksize_ : 0;
 
         // Collect input arguments
         casadi_int offset = worksize;
@@ -240,7 +608,7 @@ namespace casadi {
         for (casadi_int i=0; i<m.f_n_in; ++i) {
           if (m.copy_elision_arg[i]==-1) {
             for (casadi_int j=0; j<m.f_nnz_in[i]; ++j) {
-              g << "w["+str(k+worksize) + "] = " << g.sx_work(m.dep[k]) << ";\n";
+              g << "w["+str(k+worksize) + "] = " << work(m.dep[k]) << ";\n";
               k++;
             }
           } else {
@@ -253,19 +621,19 @@ namespace casadi {
         g << "if (" << flag << ") return 1;\n";
         for (casadi_int i=0;i<m.n_res;++i) {
           if (m.res[i]>=0) {
-            g << g.sx_work(m.res[i]) << " = ";
+            g << work(m.res[i]) << " = ";
             g << "w[" + str(i+worksize+call_.sz_w_arg) + "];\n";
           }
         }
       } else if (a.op==OP_INPUT) {
           if (!copy_elision_[k]) {
-            g << g.sx_work(a.i0) << "="
+            g << work(a.i0) << "="
               << g.arg(a.i1) << "? " << g.arg(a.i1) << "[" << a.i2 << "] : 0;\n";
           }
       } else {
 
         // Where to store the result
-        g << g.sx_work(a.i0) << "=";
+        g << work(a.i0) << "=";
 
         // What to store
         if (a.op==OP_CONST) {
@@ -273,12 +641,11 @@ namespace casadi {
         } else {
           casadi_int ndep = casadi_math<double>::ndeps(a.op);
           casadi_assert_dev(ndep>0);
-          if (ndep==1) g << g.print_op(a.op, g.sx_work(a.i1));
-          if (ndep==2) g << g.print_op(a.op, g.sx_work(a.i1), g.sx_work(a.i2));
+          if (ndep==1) g << g.print_op(a.op, work(a.i1));
+          if (ndep==2) g << g.print_op(a.op, work(a.i1), work(a.i2));
         }
         g  << ";\n";
       }
-      k++;
     }
   }
 
@@ -297,6 +664,18 @@ namespace casadi {
       {"live_variables",
        {OT_BOOL,
         "Reuse variables in the work vector"}},
+      {"bytecode",
+       {OT_BOOL,
+        "Evaluate numerically using a threaded bytecode interpreter "
+        "with fused instructions (Default: true)"}},
+      {"native",
+       {OT_BOOL,
+        "Evaluate numerically using x86-64 machine code emitted in-process, "
+        "without an external compiler (Default: false)"}},
+      {"numeric_ad",
+       {OT_BOOL,
+        "Calculate derivatives by numeric AD sweeps over the algorithm "
+        "instead of generating symbolic derivative expressions (Default: false)"}},
       {"cse",
        {OT_BOOL,
         "Perform common subexpression elimination (complexity is N*log(N) in graph size)"}},
@@ -313,11 +692,253 @@ namespace casadi {
     Dict opts = FunctionInternal::generate_options(target);
     //opts["default_in"] = default_in_;
     opts["live_variables"] = live_variables_;
+    opts["bytecode"] = bytecode_;
+    opts["native"] = native_;
+    opts["numeric_ad"] = numeric_ad_;
     opts["just_in_time_sparsity"] = just_in_time_sparsity_;
     opts["just_in_time_opencl"] = just_in_time_opencl_;
     return opts;
   }
 
+  // Options of derivative functions that apply to SXTape
+  static Dict tape_options(const Dict& opts) {
+    Dict ret;
+    for (auto&& op : opts) {
+      if (FunctionInternal::options_.find(op.first)) ret.insert(op);
+    }
+    return ret;
+  }
+
+  Function SXFunction::get_forward(casadi_int nfwd, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    if (!numeric_ad_) {
+      return XFunction<SXFunction, SX, SXNode>::get_forward(nfwd, name, inames, onames, opts);
+    }
+    return Function::create(new SXTape(name, nfwd, false), tape_options(opts));
+  }
+
+  Function SXFunction::get_reverse(casadi_int nadj, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    if (!numeric_ad_) {
+      return XFunction<SXFunction, SX, SXNode>::get_reverse(nadj, name, inames, onames, opts);
+    }
+    return Function::create(new SXTape(name, nadj, true), tape_options(opts));
+  }
+
+  // Second order partial derivatives of an operation in the operand symbols x, y
+  struct SecondPartials {
+    SXElem x, y;
+    // d2f/dx2, d2f/dxdy, d2f/dy2
+    SXElem h[3];
+  };
+
+  static SecondPartials second_partials(unsigned char op) {
+    SecondPartials ret;
+    ret.x = SXElem::sym("x");
+    ret.y = SXElem::sym("y");
+    SXElem f, d[2];
+    casadi_math<SXElem>::fun(op, ret.x, ret.y, f);
+    casadi_math<SXElem>::der(op, ret.x, ret.y, f, d);
+    SX H = densify(jacobian(SX(std::vector<SXElem>{d[0], d[1]}),
+                            SX(std::vector<SXElem>{ret.x, ret.y})));
+    ret.h[0] = H->at(0);
+    ret.h[1] = H->at(2);
+    ret.h[2] = H->at(3);
+    return ret;
+  }
+
+  // Substitute the operands into a second order partial derivative
+  static SXElem second_partial(const SXElem& t, const SecondPartials& sp,
+      const SXElem& x, const SXElem& y) {
+    if (t.get()==sp.x.get()) return x;
+    if (t.get()==sp.y.get()) return y;
+    switch (t.n_dep()) {
+    case 1:
+      return SXElem::unary(t.op(), second_partial(t->dep(0), sp, x, y));
+    case 2:
+      return SXElem::binary(t.op(), second_partial(t->dep(0), sp, x, y),
+                            second_partial(t->dep(1), sp, x, y));
+    default:
+      return t;
+    }
+  }
+
+  Function SXFunction::get_hessian(casadi_int iind, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    if (!call_.el.empty() || !free_vars_.empty()) {
+      return FunctionInternal::get_hessian(iind, name, inames, onames, opts);
+    }
+    if (verbose_) casadi_message(name_ + "::get_hessian");
+
+    // Output weights
+    std::vector<SX> lam(n_out_);
+    for (casadi_int i=0; i<n_out_; ++i) lam[i] = SX::sym(inames[n_in_+i], sparsity_out(i));
+
+    // First and second order partial derivatives of each instruction
+    casadi_int n_alg = algorithm_.size();
+    std::vector<SXElem> d(2*n_alg), h(3*n_alg);
+    std::map<unsigned char, SecondPartials> templates;
+    std::vector<SXElem>::const_iterator b_it=operations_.begin();
+    for (casadi_int k=0; k<n_alg; ++k) {
+      const ScalarAtomic& e = algorithm_[k];
+      switch (e.op) {
+      case OP_INPUT:
+      case OP_OUTPUT:
+      case OP_CONST:
+      case OP_PARAMETER:
+        break;
+      default:
+        {
+          const SXElem& f=*b_it++;
+          const SXElem &x = f->dep(0), &y = f->dep(1);
+          casadi_math<SXElem>::der(e.op, x, y, f, &d[2*k]);
+          auto it = templates.find(e.op);
+          if (it==templates.end()) {
+            it = templates.insert(std::make_pair(e.op, second_partials(e.op))).first;
+          }
+          for (casadi_int j=0; j<3; ++j) h[3*k+j] = second_partial(it->second.h[j], it->second, x, y);
+        }
+      }
+    }
+
+    // Adjoints of the work vector entries
+    std::vector<SXElem> a(worksize_, 0);
+    // Nonlinear interactions, symmetric. Entries beyond the work vector
+    // correspond to the nonzeros of input iind, which are never overwritten.
+    std::vector<std::map<casadi_int, SXElem> > W(worksize_ + nnz_in(iind));
+    auto add = [&](casadi_int j, casadi_int k, const SXElem& v) {
+      if (v.is_zero()) return;
+      for (casadi_int r=0; r<(j==k ? 1 : 2); ++r) {
+        auto it = W[j].find(k);
+        if (it==W[j].end()) {
+          W[j].insert(std::make_pair(k, v));
+        } else {
+          it->second += v;
+        }
+        std::swap(j, k);
+      }
+    };
+    // Remove an entry, returning its interactions
+    auto extract = [&](casadi_int i) {
+      std::map<casadi_int, SXElem> r;
+      r.swap(W[i]);
+      for (auto&& p : r) if (p.first!=i) W[p.first].erase(i);
+      return r;
+    };
+
+    // Reverse sweep
+    for (casadi_int k=n_alg-1; k>=0; --k) {
+      const ScalarAtomic& e = algorithm_[k];
+      switch (e.op) {
+      case OP_OUTPUT:
+        if (is_diff_out_[e.i0]) a[e.i1] += lam[e.i0].nonzeros()[e.i2];
+        break;
+      case OP_INPUT:
+        {
+          std::map<casadi_int, SXElem> r = extract(e.i0);
+          a[e.i0] = 0;
+          if (e.i1==iind && is_diff_in_[iind]) {
+            // Interactions are kept by input nonzero
+            casadi_int g = worksize_ + e.i2;
+            for (auto&& p : r) add(g, p.first==e.i0 ? g : p.first, p.second);
+          }
+        }
+        break;
+      case OP_CONST:
+      case OP_PARAMETER:
+        extract(e.i0);
+        a[e.i0] = 0;
+        break;
+      default:
+        {
+          // Operands, merged if they are the same entry
+          casadi_int np, pj[2];
+          SXElem dj[2], hj[3];
+          const SXElem *dk = &d[2*k], *hk = &h[3*k];
+          if (casadi_math<double>::ndeps(e.op)==1) {
+            np = 1;
+            pj[0] = e.i1;
+            dj[0] = dk[0];
+            hj[0] = hk[0];
+          } else if (e.i1==e.i2) {
+            np = 1;
+            pj[0] = e.i1;
+            dj[0] = dk[0] + dk[1];
+            hj[0] = hk[0] + 2*hk[1] + hk[2];
+          } else {
+            np = 2;
+            pj[0] = e.i1;
+            pj[1] = e.i2;
+            std::copy(dk, dk+2, dj);
+            std::copy(hk, hk+3, hj);
+          }
+          // Result entry may be shared with an operand, release it first
+          SXElem ai = a[e.i0];
+          a[e.i0] = 0;
+          std::map<casadi_int, SXElem> r = extract(e.i0);
+          // Push the interactions of the result to the operands
+          for (auto&& p : r) {
+            if (p.first==e.i0) {
+              add(pj[0], pj[0], dj[0]*dj[0]*p.second);
+              if (np==2) {
+                add(pj[0], pj[1], dj[0]*dj[1]*p.second);
+                add(pj[1], pj[1], dj[1]*dj[1]*p.second);
+              }
+            } else {
+              for (casadi_int j=0; j<np; ++j) {
+                add(pj[j], p.first, (pj[j]==p.first ? 2*dj[j] : dj[j])*p.second);
+              }
+            }
+          }
+          if (ai.is_zero()) break;
+          // Create the interactions of the operation itself
+          add(pj[0], pj[0], ai*hj[0]);
+          if (np==2) {
+            add(pj[0], pj[1], ai*hj[1]);
+            add(pj[1], pj[1], ai*hj[2]);
+          }
+          // Propagate adjoints
+          for (casadi_int j=0; j<np; ++j) {
+            if (!dj[j].is_zero()) a[pj[j]] += ai*dj[j];
+          }
+        }
+      }
+    }
+
+    // Interactions between the nonzeros of input iind
+    std::vector<casadi_int> ind = sparsity_in(iind).find();
+    std::vector<casadi_int> row, col;
+    std::vector<SXElem> val;
+    for (casadi_int c=0; c<nnz_in(iind); ++c) {
+      for (auto&& p : W[worksize_ + c]) {
+        if (p.first<worksize_) continue;
+        row.push_back(ind[p.first-worksize_]);
+        col.push_back(ind[c]);
+        val.push_back(p.second);
+      }
+    }
+    casadi_int n = numel_in(iind);
+    SX H = SX::triplet(row, col, SX(val), n, n);
+
+    // Assemble
+    std::vector<SX> arg = in_;
+    arg.insert(arg.end(), lam.begin(), lam.end());
+    return Function(name, arg, {H}, inames, onames, opts);
+  }
+
+  std::vector<SXNode*> SXFunction::symbolic_nodes(const SX& x) {
+    std::vector<SXNode*> ret;
+    ret.reserve(x.nnz());
+    for (auto&& e : x.nonzeros()) ret.push_back(e.get());
+    return ret;
+  }
+
   void SXFunction::init(const Dict& opts) {
     // Call the init function of the base class
     XFunction<SXFunction, SX, SXNode>::init(opts);
@@ -325,6 +946,9 @@ namespace casadi {
 
     // Default (temporary) options
     live_variables_ = true;
+    bytecode_ = true;
+    native_ = false;
+    numeric_ad_ = false;
 
     bool cse_opt = false;
     bool allow_free = false;
@@ -335,6 +959,12 @@ namespace casadi {
         default_in_ = op.second;
       } else if (op.first=="live_variables") {
         live_variables_ = op.second;
+      } else if (op.first=="bytecode") {
+        bytecode_ = op.second;
+      } else if (op.first=="native") {
+        native_ = op.second;
+      } else if (op.first=="numeric_ad") {
+        numeric_ad_ = op.second;
       } else if (op.first=="just_in_time_opencl") {
         just_in_time_opencl_ = op.second;
       } else if (op.first=="just_in_time_sparsity") {
@@ -358,16 +988,15 @@ namespace casadi {
                             "Option 'default_in' has incorrect length");
     }
 
-#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
-    std::lock_guard<std::mutex> lock(SX::get_mutex_temp());
-#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
-
     // Stack used to sort the computational graph
     std::stack<SXNode*> s;
 
     // All nodes
     std::vector<SXNode*> nodes;
 
+    // Place of each node in the sorted graph, local to this function
+    NodeMap<SXNode> node_index;
+
     // Add the list of nodes
     casadi_int ind=0;
     for (auto it = out_.begin(); it != out_.end(); ++it, ++ind) {
@@ -375,7 +1004,7 @@ namespace casadi {
       for (auto itc = (*it)->begin(); itc != (*it)->end(); ++itc, ++nz) {
         // Add outputs to the list
         s.push(itc->get());
-        sort_depth_first(s, nodes);
+        sort_depth_first(s, nodes, node_index);
 
         // A null pointer means an output instruction
         nodes.push_back(static_cast<SXNode*>(nullptr));
@@ -386,7 +1015,7 @@ namespace casadi {
     // Set the temporary variables to be the corresponding place in the sorted graph
     for (casadi_int i=0; i<nodes.size(); ++i) {
       if (nodes[i]) {
-        nodes[i]->temp = static_cast<int>(i);
+        node_index[nodes[i]] = i;
       }
     }
 
@@ -422,7 +1051,7 @@ namespace casadi {
     algorithm_.resize(0);
     algorithm_.reserve(nodes.size());
 
-    // Mapping of node index (cfr. temp) to algorithm index
+    // Mapping of node index (cfr. node_index) to algorithm index
     std::vector<int> alg_index;
     alg_index.reserve(nodes.size());
 
@@ -444,16 +1073,16 @@ namespace casadi {
       switch (ae.op) {
       case OP_CONST: // constant
         ae.d = n->to_double();
-        ae.i0 = n->temp;
+        ae.i0 = node_index.get(n);
         break;
       case OP_PARAMETER: // a parameter or input
         symb_loc.push_back(std::make_pair(algorithm_.size(), n));
-        ae.i0 = n->temp;
+        ae.i0 = node_index.get(n);
         ae.d = 0; // value not used, but set here to avoid uninitialized data in serialization
         break;
       case OP_OUTPUT: // output instruction
         ae.i0 = curr_oind;
-        ae.i1 = out_[curr_oind]->at(curr_nz)->temp;
+        ae.i1 = node_index.get(out_[curr_oind]->at(curr_nz).get());
         ae.i2 = curr_nz;
 
         // Go to the next nonzero
@@ -472,7 +1101,7 @@ namespace casadi {
         break;
       case OP_CALL: // Call node
         {
-          ae.i0 = n->temp;
+          ae.i0 = node_index.get(n);
 
           // Index into ExtentedAlgEl collection
           ae.i1 = call_.el.size();
@@ -498,22 +1127,22 @@ namespace casadi {
 
           // Populate the dependency slots with node ids.
           for (casadi_int i=0; i<ndeps; ++i) {
-            dep[i] = n->dep(i).get()->temp;
+            dep[i] = node_index.get(n->dep(i).get());
           }
         }
         break;
       case -1: // Output extraction node
         {
-          dep = &algorithm_.at(alg_index.at(n->dep(0).get()->temp)).i1;
+          dep = &algorithm_.at(alg_index.at(node_index.get(n->dep(0).get()))).i1;
           int oind = static_cast<OutputSX*>(n)->oind_;
           casadi_assert(call_.el.at(dep[0]).res.at(oind)==-1, "Duplicate");
-          call_.el.at(dep[0]).res.at(oind) = n->temp;
+          call_.el.at(dep[0]).res.at(oind) = node_index.get(n);
         }
         break;
       default:       // Unary or binary operation
-        ae.i0 = n->temp;
-        ae.i1 = n->dep(0).get()->temp;
-        ae.i2 = n->dep(1).get()->temp;
+        ae.i0 = node_index.get(n);
+        ae.i1 = node_index.get(n->dep(0).get());
+        ae.i2 = node_index.get(n->dep(1).get());
       }
 
       // Increase count of dependencies
@@ -612,16 +1241,10 @@ namespace casadi {
     alloc_iw(call_.sz_iw, true);
     alloc_w(call_.sz_w+call_.sz_w_arg+call_.sz_w_res, true);
 
-    // Reset the temporary variables
-    for (casadi_int i=0; i<nodes.size(); ++i) {
-      if (nodes[i]) {
-        nodes[i]->temp = 0;
-      }
-    }
-
     // Now mark each input's place in the algorithm
+    NodeMap<SXNode> input_loc(symb_loc.size());
     for (auto it=symb_loc.begin(); it!=symb_loc.end(); ++it) {
-      it->second->temp = it->first+1;
+      input_loc[it->second] = it->first+1;
     }
 
     // Add input instructions
@@ -629,7 +1252,8 @@ namespace casadi {
     for (int ind=0; ind<in_.size(); ++ind) {
       int nz=0;
       for (auto itc = in_[ind]->begin(); itc != in_[ind]->end(); ++itc, ++nz) {
-        int i = itc->get_temp()-1;
+        casadi_int& loc = input_loc[itc->get()];
+        int i = static_cast<int>(loc-1);
         if (i>=0) {
           // Mark as input
           algorithm_[i].op = OP_INPUT;
@@ -639,7 +1263,7 @@ namespace casadi {
           algorithm_[i].i2 = nz;
 
           // Mark input as read
-          itc->set_temp(0);
+          loc = 0;
         }
       }
     }
@@ -648,12 +1272,9 @@ namespace casadi {
     free_vars_.clear();
     for (std::vector<std::pair<int, SXNode*> >::const_iterator it=symb_loc.begin();
          it!=symb_loc.end(); ++it) {
-      if (it->second->temp!=0) {
+      if (input_loc.get(it->second)!=0) {
         // Save to list of free parameters
         free_vars_.push_back(SXElem::create(it->second));
-
-        // Remove marker
-        it->second->temp=0;
       }
     }
 
@@ -665,6 +1286,17 @@ namespace casadi {
     }
 
     init_copy_elision();
+    init_bytecode();
+    init_native();
+
+    // Numeric tape AD
+    if (numeric_ad_ && (!call_.el.empty() || !free_vars_.empty())) {
+      casadi_warning(name_ + ": Numeric AD does not support calls or free variables, "
+                     "falling back to symbolic derivatives.");
+      numeric_ad_ = false;
+    }
+    // Jacobian through the forward and reverse functions
+    if (numeric_ad_) enable_jacobian_ = false;
 
     // Initialize just-in-time compilation for numeric evaluation using OpenCL
     if (just_in_time_opencl_) {
@@ -1354,6 +1986,102 @@ namespace casadi {
     return 0;
   }
 
+  // Forward sweep with NW words per nonzero, NW=0 for a run-time width
+  template<casadi_int NW>
+  static void sx_sp_forward_wide(const std::vector<ScalarAtomic>& alg,
+      const bvec_t** arg, bvec_t** res, bvec_t* w, casadi_int nw) {
+    const casadi_int n = NW ? NW : nw;
+    for (auto&& e : alg) {
+      bvec_t* r = w + e.i0*n;
+      switch (e.op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        std::fill_n(r, n, 0); break;
+      case OP_INPUT:
+        if (arg[e.i1]==nullptr) {
+          std::fill_n(r, n, 0);
+        } else {
+          std::copy_n(arg[e.i1] + e.i2*n, n, r);
+        }
+        break;
+      case OP_OUTPUT:
+        if (res[e.i0]!=nullptr) std::copy_n(w + e.i1*n, n, res[e.i0] + e.i2*n);
+        break;
+      default: // Unary or binary operation
+        {
+          const bvec_t *x = w + e.i1*n, *y = w + e.i2*n;
+          for (casadi_int k=0; k<n; ++k) r[k] = x[k] | y[k];
+        }
+      }
+    }
+  }
+
+  // Reverse sweep with NW words per nonzero, NW=0 for a run-time width
+  template<casadi_int NW>
+  static void sx_sp_reverse_wide(const std::vector<ScalarAtomic>& alg,
+      bvec_t** arg, bvec_t** res, bvec_t* w, casadi_int nw) {
+    const casadi_int n = NW ? NW : nw;
+    for (auto it=alg.rbegin(); it!=alg.rend(); ++it) {
+      bvec_t* r = w + it->i0*n;
+      switch (it->op) {
+      case OP_CONST:
+      case OP_PARAMETER:
+        std::fill_n(r, n, 0);
+        break;
+      case OP_INPUT:
+        if (arg[it->i1]!=nullptr) {
+          bvec_t* a = arg[it->i1] + it->i2*n;
+          for (casadi_int k=0; k<n; ++k) a[k] |= r[k];
+        }
+        std::fill_n(r, n, 0);
+        break;
+      case OP_OUTPUT:
+        if (res[it->i0]!=nullptr) {
+          bvec_t *x = w + it->i1*n, *s = res[it->i0] + it->i2*n;
+          for (casadi_int k=0; k<n; ++k) x[k] |= s[k];
+          std::fill_n(s, n, 0);
+        }
+        break;
+      default: // Unary or binary operation
+        {
+          bvec_t *x = w + it->i1*n, *y = w + it->i2*n;
+          for (casadi_int k=0; k<n; ++k) {
+            bvec_t seed = r[k];
+            r[k] = 0;
+            x[k] |= seed;
+            y[k] |= seed;
+          }
+        }
+      }
+    }
+  }
+
+  int SXFunction::sp_forward_wide(const bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    casadi_assert_dev(call_.el.empty());
+    // Fixed widths let the compiler unroll and vectorize the word loops
+    switch (nw) {
+    case 2: sx_sp_forward_wide<2>(algorithm_, arg, res, w, nw); break;
+    case 4: sx_sp_forward_wide<4>(algorithm_, arg, res, w, nw); break;
+    case 8: sx_sp_forward_wide<8>(algorithm_, arg, res, w, nw); break;
+    default: sx_sp_forward_wide<0>(algorithm_, arg, res, w, nw);
+    }
+    return 0;
+  }
+
+  int SXFunction::sp_reverse_wide(bvec_t** arg, bvec_t** res,
+      casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const {
+    casadi_assert_dev(call_.el.empty());
+    std::fill_n(w, worksize_*nw, 0);
+    switch (nw) {
+    case 2: sx_sp_reverse_wide<2>(algorithm_, arg, res, w, nw); break;
+    case 4: sx_sp_reverse_wide<4>(algorithm_, arg, res, w, nw); break;
+    case 8: sx_sp_reverse_wide<8>(algorithm_, arg, res, w, nw); break;
+    default: sx_sp_reverse_wide<0>(algorithm_, arg, res, w, nw);
+    }
+    return 0;
+  }
+
   const SX SXFunction::sx_in(casadi_int ind) const {
     return in_.at(ind);
   }
@@ -1469,7 +2197,7 @@ namespace casadi {
 
   SXFunction::SXFunction(DeserializingStream& s) :
     XFunction<SXFunction, SX, SXNode>(s) {
-    int version = s.version("SXFunction", 1, 2);
+    int version = s.version("SXFunction", 1, 6);
     size_t n_instructions;
     s.unpack("SXFunction::n_instr", n_instructions);
 
@@ -1518,12 +2246,26 @@ namespace casadi {
     }
 
     algorithm_.resize(n_instructions);
-    for (casadi_int k=0;k<n_instructions;++k) {
-      AlgEl& e = algorithm_[k];
-      s.unpack("SXFunction::ScalarAtomic::op", e.op);
-      s.unpack("SXFunction::ScalarAtomic::i0", e.i0);
-      s.unpack("SXFunction::ScalarAtomic::i1", e.i1);
-      s.unpack("SXFunction::ScalarAtomic::i2", e.i2);
+    if (version>=3) {
+      // Flattened algorithm, allows bulk reads
+      std::vector<int> alg;
+      s.unpack("SXFunction::algorithm", alg);
+      casadi_assert_dev(alg.size()==4*n_instructions);
+      for (casadi_int k=0;k<n_instructions;++k) {
+        AlgEl& e = algorithm_[k];
+        e.op = alg[4*k];
+        e.i0 = alg[4*k+1];
+        e.i1 = alg[4*k+2];
+        e.i2 = alg[4*k+3];
+      }
+    } else {
+      for (casadi_int k=0;k<n_instructions;++k) {
+        AlgEl& e = algorithm_[k];
+        s.unpack("SXFunction::ScalarAtomic::op", e.op);
+        s.unpack("SXFunction::ScalarAtomic::i0", e.i0);
+        s.unpack("SXFunction::ScalarAtomic::i1", e.i1);
+        s.unpack("SXFunction::ScalarAtomic::i2", e.i2);
+      }
     }
 
     // Default (persistent) options
@@ -1531,13 +2273,31 @@ namespace casadi {
     just_in_time_sparsity_ = false;
 
     s.unpack("SXFunction::live_variables", live_variables_);
+    if (version>=4) {
+      s.unpack("SXFunction::bytecode", bytecode_);
+    } else {
+      bytecode_ = true;
+    }
+    if (version>=5) {
+      s.unpack("SXFunction::native", native_);
+    } else {
+      native_ = false;
+    }
+    if (version>=6) {
+      s.unpack("SXFunction::numeric_ad", numeric_ad_);
+    } else {
+      numeric_ad_ = false;
+    }
+    native_code_ = nullptr;
+    init_bytecode();
+    init_native();
 
     XFunction<SXFunction, SX, SXNode>::delayed_deserialize_members(s);
   }
 
   void SXFunction::serialize_body(SerializingStream &s) const {
     XFunction<SXFunction, SX, SXNode>::serialize_body(s);
-    s.version("SXFunction", 2);
+    s.version("SXFunction", 6);
     s.pack("SXFunction::n_instr", algorithm_.size());
 
     s.pack("SXFunction::worksize", worksize_);
@@ -1565,15 +2325,21 @@ namespace casadi {
 
     s.pack("SXFunction::copy_elision", copy_elision_);
 
-    // Loop over algorithm
+    // Flatten algorithm, allows bulk writes
+    std::vector<int> alg;
+    alg.reserve(4*algorithm_.size());
     for (const auto& e : algorithm_) {
-      s.pack("SXFunction::ScalarAtomic::op", e.op);
-      s.pack("SXFunction::ScalarAtomic::i0", e.i0);
-      s.pack("SXFunction::ScalarAtomic::i1", e.i1);
-      s.pack("SXFunction::ScalarAtomic::i2", e.i2);
+      alg.push_back(e.op);
+      alg.push_back(e.i0);
+      alg.push_back(e.i1);
+      alg.push_back(e.i2);
     }
+    s.pack("SXFunction::algorithm", alg);
 
     s.pack("SXFunction::live_variables", live_variables_);
+    s.pack("SXFunction::bytecode", bytecode_);
+    s.pack("SXFunction::native", native_);
+    s.pack("SXFunction::numeric_ad", numeric_ad_);
 
     XFunction<SXFunction, SX, SXNode>::delayed_serialize_members(s);
   }
@@ -31,6 +31,8 @@
 /// \cond INTERNAL
 
 namespace casadi {
+  class NativeCode;
+
   /** \brief  An atomic operation for the SXElem virtual machine
 
       \identifier{ua} */
@@ -276,6 +278,20 @@ class CASADI_EXPORT SXFunction :
     std::vector<ExtendedAlgEl> el;
   } call_;
 
+  /** \brief Compact instruction stream for the numeric interpreter
+
+      Struct-of-arrays layout, one entry per instruction. Common instruction
+      sequences are fused into a single instruction occupying the entries of
+      all its constituents; the stream is terminated by a sentinel. */
+  struct Bytecode {
+    // Interpreter opcode and, for generic instructions, the CasADi operation
+    std::vector<unsigned char> op, fop;
+    // Work vector indices, cfr AlgEl
+    std::vector<int> i0, i1, i2;
+    // Constant pool
+    std::vector<double> c;
+  } bc_;
+
     /** \brief Deserialize without type information
 
         \identifier{v1} */
@@ -297,11 +313,61 @@ class CASADI_EXPORT SXFunction :
       \identifier{v3} */
   void init(const Dict& opts) override;
 
+  ///@{
+  /** \brief Derivative functions, by numeric tape AD if enabled */
+  Function get_forward(casadi_int nfwd, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+  Function get_reverse(casadi_int nadj, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+  ///@}
+
+  /** \brief Hessian of the weighted outputs by edge pushing
+
+      A single reverse sweep over the algorithm propagates the adjoints
+      together with the nonlinear interactions between live work vector
+      entries, giving the sparsity pattern and the nonzeros at once. */
+  Function get_hessian(casadi_int iind, const std::string& name,
+                       const std::vector<std::string>& inames,
+                       const std::vector<std::string>& onames,
+                       const Dict& opts) const override;
+
+  /** \brief Symbolic nodes of an input expression */
+  static std::vector<SXNode*> symbolic_nodes(const SX& x);
+
   /** \brief Part of initialize responsible of prepaprign copy elision
 
       \identifier{29h} */
   void init_copy_elision();
 
+  /** \brief Translate the algorithm into the bytecode form used by eval */
+  void init_bytecode();
+
+  /** \brief Emit machine code for numeric evaluation, if requested and possible */
+  void init_native();
+
+  /** \brief Evaluate numerically using the bytecode interpreter */
+  int eval_bytecode(const double** arg, double** res, casadi_int* iw, double* w) const;
+
+  /// Number of points evaluated simultaneously by eval_batch
+  static const casadi_int batch_size = 8;
+
+  /** \brief Evaluate numerically at n points simultaneously
+
+      Each work vector entry holds batch_size lanes, one per point, so that
+      every instruction is dispatched once and applied lane-wise. */
+  int eval_batch(const double** arg, double** res, casadi_int* iw, double* w,
+    void* mem, casadi_int n) const override;
+
+  /// Is eval_batch supported?
+  bool has_eval_batch() const override;
+
+  /// Length of the real work vector needed by eval_batch
+  size_t sz_w_batch() const override { return worksize_*batch_size;}
+
   /** \brief  Get the size of the work vector, for codegen
 
       \identifier{290} */
@@ -317,6 +383,19 @@ class CASADI_EXPORT SXFunction :
       \identifier{v5} */
   void codegen_body(CodeGenerator& g) const override;
 
+  /** \brief Number of parts the algorithm is split into for codegen
+
+      With the "unit_size" option, long algorithms are divided over functions
+      that may be compiled separately, keeping all work in the work vector. */
+  casadi_int codegen_n_part(const CodeGenerator& g) const;
+
+  /// Name of a part in codegen
+  std::string codegen_part_name(CodeGenerator& g, casadi_int k) const;
+
+  /// Generate code for the algorithm elements in [begin, end)
+  void codegen_algorithm(CodeGenerator& g, casadi_int begin, casadi_int end,
+    bool in_w) const;
+
   /** \brief  Propagate sparsity forward
 
       \identifier{v6} */
@@ -328,6 +407,23 @@ class CASADI_EXPORT SXFunction :
       \identifier{v7} */
   int sp_reverse(bvec_t** arg, bvec_t** res, casadi_int* iw, bvec_t* w, void* mem) const override;
 
+  /// Wide sparsity propagation, unless there are function calls
+  bool has_sp_wide() const override { return call_.el.empty();}
+
+  /// Concurrent sparsity propagation, unless there are function calls
+  bool has_sp_parallel() const override { return call_.el.empty();}
+
+  /// Get required length of w field for wide sparsity propagation
+  size_t sz_w_sp_wide(casadi_int nw) const override { return worksize_*nw;}
+
+  /// Propagate sparsity forward, nw consecutive words per nonzero
+  int sp_forward_wide(const bvec_t** arg, bvec_t** res,
+    casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const override;
+
+  /// Propagate sparsity backwards, nw consecutive words per nonzero
+  int sp_reverse_wide(bvec_t** arg, bvec_t** res,
+    casadi_int* iw, bvec_t* w, void* mem, casadi_int nw) const override;
+
   /** *\brief get SX expression associated with instructions
 
        \identifier{v8} */
@@ -356,6 +452,18 @@ class CASADI_EXPORT SXFunction :
   /// Live variables?
   bool live_variables_;
 
+  /// Evaluate using the bytecode interpreter?
+  bool bytecode_;
+
+  /// Emit machine code in-process for numeric evaluation?
+  bool native_;
+
+  /// Machine code, if emitted
+  NativeCode* native_code_;
+
+  /// Derivatives by numeric tape AD instead of symbolic expressions?
+  bool numeric_ad_;
+
 protected:
   template<typename T>
   void call_fwd(const AlgEl& e, const T** arg, T** res, casadi_int* iw, T* w) const;
@@ -0,0 +1,311 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#include "sx_tape.hpp"
+#include "sx_function.hpp"
+
+namespace casadi {
+
+  SXTape::SXTape(const std::string& name, casadi_int n, bool reverse)
+    : FunctionInternal(name), f_(nullptr), n_(n), reverse_(reverse) {
+  }
+
+  SXTape::~SXTape() {
+    clear_mem();
+  }
+
+  SXTape::SXTape(DeserializingStream& s) : FunctionInternal(s) {
+    s.version("SXTape", 1);
+    s.unpack("SXTape::n", n_);
+    s.unpack("SXTape::reverse", reverse_);
+    f_ = dynamic_cast<const SXFunction*>(derivative_of_.get());
+    casadi_assert_dev(f_!=nullptr);
+  }
+
+  void SXTape::serialize_body(SerializingStream &s) const {
+    FunctionInternal::serialize_body(s);
+    s.version("SXTape", 1);
+    s.pack("SXTape::n", n_);
+    s.pack("SXTape::reverse", reverse_);
+  }
+
+  size_t SXTape::get_n_in() {
+    const Function& f = derivative_of_;
+    return f.n_in() + f.n_out() + (reverse_ ? f.n_out() : f.n_in());
+  }
+
+  size_t SXTape::get_n_out() {
+    const Function& f = derivative_of_;
+    return reverse_ ? f.n_in() : f.n_out();
+  }
+
+  Sparsity SXTape::get_sparsity_in(casadi_int i) {
+    const Function& f = derivative_of_;
+    casadi_int n_in = f.n_in(), n_out = f.n_out();
+    if (i<n_in) {
+      // Non-differentiated input
+      return f.sparsity_in(i);
+    } else if (i<n_in+n_out) {
+      // Non-differentiated output, not used
+      return Sparsity(f.size_out(i-n_in));
+    } else if (reverse_) {
+      // Adjoint seeds
+      return repmat(f.sparsity_out(i-n_in-n_out), 1, n_);
+    } else {
+      // Forward seeds
+      return repmat(f.sparsity_in(i-n_in-n_out), 1, n_);
+    }
+  }
+
+  Sparsity SXTape::get_sparsity_out(casadi_int i) {
+    const Function& f = derivative_of_;
+    return repmat(reverse_ ? f.sparsity_in(i) : f.sparsity_out(i), 1, n_);
+  }
+
+  std::string SXTape::get_name_in(casadi_int i) {
+    const Function& f = derivative_of_;
+    casadi_int n_in = f.n_in(), n_out = f.n_out();
+    if (i<n_in) {
+      return f.name_in(i);
+    } else if (i<n_in+n_out) {
+      return "out_" + f.name_out(i-n_in);
+    } else if (reverse_) {
+      return "adj_" + f.name_out(i-n_in-n_out);
+    } else {
+      return "fwd_" + f.name_in(i-n_in-n_out);
+    }
+  }
+
+  std::string SXTape::get_name_out(casadi_int i) {
+    const Function& f = derivative_of_;
+    return reverse_ ? "adj_" + f.name_in(i) : "fwd_" + f.name_out(i);
+  }
+
+  void SXTape::init(const Dict& opts) {
+    // Call the initialization method of the base class
+    FunctionInternal::init(opts);
+
+    f_ = dynamic_cast<const SXFunction*>(derivative_of_.get());
+    casadi_assert(f_!=nullptr, "SXTape requires an SXFunction");
+    casadi_assert(f_->call_.el.empty(), "SXTape does not support call nodes");
+    casadi_assert(f_->free_vars_.empty(), "SXTape does not support free variables");
+
+    // Values and one derivative per direction for each work vector entry
+    alloc_w(f_->worksize_ * (1 + n_), true);
+    // Partial derivatives of each instruction
+    if (reverse_) alloc_w(2 * f_->algorithm_.size(), true);
+    // Generated code evaluates the symbolic equivalent in the same work vector
+    if (jit_) alloc_w(symbolic().sz_w());
+  }
+
+  int SXTape::eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const {
+    if (reverse_) {
+      eval_reverse(arg, res, w);
+    } else {
+      eval_forward(arg, res, w);
+    }
+    return 0;
+  }
+
+  const Function& SXTape::symbolic() const {
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    std::lock_guard<std::mutex> lock(symbolic_mtx_);
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+    if (symbolic_.is_null()) {
+      typedef XFunction<SXFunction, SX, SXNode> Base;
+      // Derivatives of the symbolic equivalent are taped again
+      Dict opts = {{"numeric_ad", true}};
+      if (reverse_) {
+        symbolic_ = f_->Base::get_reverse(n_, name_, name_in_, name_out_, opts);
+      } else {
+        symbolic_ = f_->Base::get_forward(n_, name_, name_in_, name_out_, opts);
+      }
+    }
+    return symbolic_;
+  }
+
+  Function SXTape::get_forward(casadi_int nfwd, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    const Function& f = symbolic();
+    Dict f_opts = opts;
+    f_opts["derivative_of"] = f;
+    return f->get_forward(nfwd, name, inames, onames, f_opts);
+  }
+
+  Function SXTape::get_reverse(casadi_int nadj, const std::string& name,
+      const std::vector<std::string>& inames,
+      const std::vector<std::string>& onames,
+      const Dict& opts) const {
+    const Function& f = symbolic();
+    Dict f_opts = opts;
+    f_opts["derivative_of"] = f;
+    return f->get_reverse(nadj, name, inames, onames, f_opts);
+  }
+
+  void SXTape::codegen_declarations(CodeGenerator& g) const {
+    g.add_dependency(symbolic());
+  }
+
+  void SXTape::codegen_body(CodeGenerator& g) const {
+    const Function& f = symbolic();
+    casadi_assert_dev(f.sz_arg()<=sz_arg() && f.sz_res()<=sz_res() && f.sz_iw()<=sz_iw());
+    g << "if (" << g(f, "arg", "res", "iw", "w") << ") return 1;\n";
+  }
+
+  size_t SXTape::codegen_sz_w(const CodeGenerator& g) const {
+    return std::max(sz_w(), symbolic().sz_w());
+  }
+
+  void SXTape::eval_forward(const double** arg, double** res, double* w) const {
+    casadi_int n_in = f_->n_in_, n_out = f_->n_out_;
+    // Forward seeds and sensitivities
+    const double** seed = arg + n_in + n_out;
+    double** sens = res;
+    // Work vector entry k has value v[k] and tangents t[k*n_ + d]
+    double* v = w;
+    double* t = w + f_->worksize_;
+    for (auto&& e : f_->algorithm_) {
+      double* t0 = t + e.i0*n_;
+      switch (e.op) {
+      case OP_CONST:
+        v[e.i0] = e.d;
+        std::fill_n(t0, n_, 0.);
+        break;
+      case OP_INPUT:
+        {
+          v[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2];
+          const double* s = seed[e.i1];
+          if (s==nullptr || !f_->is_diff_in_[e.i1]) {
+            std::fill_n(t0, n_, 0.);
+          } else {
+            casadi_int nnz = f_->nnz_in(e.i1);
+            for (casadi_int d=0; d<n_; ++d) t0[d] = s[e.i2 + d*nnz];
+          }
+        }
+        break;
+      case OP_OUTPUT:
+        if (sens[e.i0]!=nullptr) {
+          casadi_int nnz = f_->nnz_out(e.i0);
+          const double* t1 = t + e.i1*n_;
+          bool diff = f_->is_diff_out_[e.i0];
+          for (casadi_int d=0; d<n_; ++d) sens[e.i0][e.i2 + d*nnz] = diff ? t1[d] : 0;
+        }
+        break;
+      default:
+        {
+          // Value and partial derivatives, operands may share the result entry
+          double f, p[2];
+          casadi_math<double>::derF(e.op, v[e.i1], v[e.i2], f, p);
+          const double* t1 = t + e.i1*n_;
+          const double* t2 = t + e.i2*n_;
+          for (casadi_int d=0; d<n_; ++d) t0[d] = p[0]*t1[d] + p[1]*t2[d];
+          v[e.i0] = f;
+        }
+      }
+    }
+  }
+
+  void SXTape::eval_reverse(const double** arg, double** res, double* w) const {
+    casadi_int n_in = f_->n_in_, n_out = f_->n_out_;
+    const std::vector<ScalarAtomic>& alg = f_->algorithm_;
+    // Adjoint seeds and sensitivities
+    const double** seed = arg + n_in + n_out;
+    double** sens = res;
+    // Values, adjoints and partial derivatives
+    double* v = w;
+    double* a = w + f_->worksize_;
+    double* p = a + f_->worksize_*n_;
+
+    // Forward sweep, record partial derivatives
+    for (casadi_int k=0; k<alg.size(); ++k) {
+      const ScalarAtomic& e = alg[k];
+      switch (e.op) {
+      case OP_CONST:
+        v[e.i0] = e.d;
+        break;
+      case OP_INPUT:
+        v[e.i0] = arg[e.i1]==nullptr ? 0 : arg[e.i1][e.i2];
+        break;
+      case OP_OUTPUT:
+        break;
+      default:
+        {
+          double f;
+          casadi_math<double>::derF(e.op, v[e.i1], v[e.i2], f, p + 2*k);
+          v[e.i0] = f;
+        }
+      }
+    }
+
+    // Clear adjoints and sensitivities
+    std::fill_n(a, f_->worksize_*n_, 0.);
+    for (casadi_int i=0; i<n_in; ++i) {
+      if (sens[i]) std::fill_n(sens[i], f_->nnz_in(i)*n_, 0.);
+    }
+
+    // Reverse sweep
+    for (casadi_int k=alg.size()-1; k>=0; --k) {
+      const ScalarAtomic& e = alg[k];
+      double* a0 = a + e.i0*n_;
+      switch (e.op) {
+      case OP_CONST:
+        std::fill_n(a0, n_, 0.);
+        break;
+      case OP_INPUT:
+        if (sens[e.i1]!=nullptr && f_->is_diff_in_[e.i1]) {
+          casadi_int nnz = f_->nnz_in(e.i1);
+          for (casadi_int d=0; d<n_; ++d) sens[e.i1][e.i2 + d*nnz] += a0[d];
+        }
+        std::fill_n(a0, n_, 0.);
+        break;
+      case OP_OUTPUT:
+        if (seed[e.i0]!=nullptr && f_->is_diff_out_[e.i0]) {
+          casadi_int nnz = f_->nnz_out(e.i0);
+          double* a1 = a + e.i1*n_;
+          for (casadi_int d=0; d<n_; ++d) a1[d] += seed[e.i0][e.i2 + d*nnz];
+        }
+        break;
+      default:
+        {
+          // Result entry may be shared with an operand, release it first
+          const double* pk = p + 2*k;
+          double* a1 = a + e.i1*n_;
+          double* a2 = a + e.i2*n_;
+          for (casadi_int d=0; d<n_; ++d) {
+            double s = a0[d];
+            a0[d] = 0;
+            a1[d] += pk[0]*s;
+            a2[d] += pk[1]*s;
+          }
+        }
+      }
+    }
+  }
+
+} // namespace casadi
@@ -0,0 +1,157 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+
+#ifndef CASADI_SX_TAPE_HPP
+#define CASADI_SX_TAPE_HPP
+
+#include "function_internal.hpp"
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  class SXFunction;
+
+  /** \brief Directional derivatives of an SXFunction by numeric tape AD
+
+      Sweeps over the algorithm of the differentiated SXFunction with a block
+      of seeds, instead of building symbolic derivative expressions. Forward
+      mode propagates tangents alongside the nominal values. Reverse mode
+      records the partial derivatives of each instruction in a forward sweep
+      and propagates adjoints in a backward sweep.
+
+      The signature is that of the forward(n) and reverse(n) functions.
+      Derivatives of the tape and generated code use the symbolic forward(n)
+      or reverse(n) function instead, which is built on first use. With the
+      jit option, the work vector also covers the symbolic equivalent.
+  */
+  class CASADI_EXPORT SXTape : public FunctionInternal {
+  public:
+    /** \brief Constructor, use with the option derivative_of
+
+        \param n        Number of directions
+        \param reverse  Reverse mode, otherwise forward mode
+    */
+    SXTape(const std::string& name, casadi_int n, bool reverse);
+
+    /** \brief Destructor */
+    ~SXTape() override;
+
+    /** \brief Get type name */
+    std::string class_name() const override { return "SXTape";}
+
+    ///@{
+    /** \brief Number of function inputs and outputs */
+    size_t get_n_in() override;
+    size_t get_n_out() override;
+    ///@}
+
+    /// @{
+    /** \brief Sparsities of function inputs and outputs */
+    Sparsity get_sparsity_in(casadi_int i) override;
+    Sparsity get_sparsity_out(casadi_int i) override;
+    /// @}
+
+    ///@{
+    /** \brief Names of function input and outputs */
+    std::string get_name_in(casadi_int i) override;
+    std::string get_name_out(casadi_int i) override;
+    ///@}
+
+    /** \brief Initialize */
+    void init(const Dict& opts) override;
+
+    /** \brief Evaluate numerically */
+    int eval(const double** arg, double** res, casadi_int* iw, double* w,
+      void* mem) const override;
+
+    ///@{
+    /** \brief Forward and reverse mode derivatives, by the symbolic equivalent */
+    bool has_forward(casadi_int nfwd) const override { return true;}
+    Function get_forward(casadi_int nfwd, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    bool has_reverse(casadi_int nadj) const override { return true;}
+    Function get_reverse(casadi_int nadj, const std::string& name,
+                         const std::vector<std::string>& inames,
+                         const std::vector<std::string>& onames,
+                         const Dict& opts) const override;
+    ///@}
+
+    /** \brief Is codegen supported? */
+    bool has_codegen() const override { return true;}
+
+    /** \brief Generate code for the declarations of the C function */
+    void codegen_declarations(CodeGenerator& g) const override;
+
+    /** \brief Generate code for the body of the C function */
+    void codegen_body(CodeGenerator& g) const override;
+
+    /** \brief Work vector size of generated code, covers the symbolic equivalent */
+    size_t codegen_sz_w(const CodeGenerator& g) const override;
+
+    /** \brief Serialize an object without type information */
+    void serialize_body(SerializingStream &s) const override;
+
+    /** \brief Deserialize without type information */
+    static ProtoFunction* deserialize(DeserializingStream& s) { return new SXTape(s); }
+
+  protected:
+    /** \brief Deserializing constructor */
+    explicit SXTape(DeserializingStream& s);
+
+    // Symbolic forward(n) or reverse(n) function of the differentiated function
+    const Function& symbolic() const;
+
+    // Forward sweep
+    void eval_forward(const double** arg, double** res, double* w) const;
+
+    // Forward sweep recording partial derivatives, then reverse sweep
+    void eval_reverse(const double** arg, double** res, double* w) const;
+
+    // Differentiated function
+    const SXFunction* f_;
+
+    // Number of directions
+    casadi_int n_;
+
+    // Reverse mode?
+    bool reverse_;
+
+    // Symbolic equivalent, built on first use
+    mutable Function symbolic_;
+
+#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
+    /// Mutex for thread safety
+    mutable std::mutex symbolic_mtx_;
+#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_SX_TAPE_HPP
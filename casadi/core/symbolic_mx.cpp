@@ -90,7 +90,7 @@ namespace casadi {
 
   void SymbolicMX::serialize_body(SerializingStream& s) const {
     MXNode::serialize_body(s);
-    s.pack("SymbolicMX::name", name_);
+    s.pack("SymbolicMX::name", s.names() ? name_ : std::string());
   }
 
   SymbolicMX::SymbolicMX(DeserializingStream& s) : MXNode(s) {
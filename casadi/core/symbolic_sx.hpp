@@ -71,7 +71,7 @@ public:
   }
 
   void serialize_node(SerializingStream& s) const override {
-    s.pack("SymbolicSX::name", name_);
+    s.pack("SymbolicSX::name", s.names() ? name_ : std::string());
   }
 
   static SXNode* deserialize(DeserializingStream& s) {
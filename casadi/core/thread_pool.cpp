@@ -0,0 +1,201 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#include "thread_pool.hpp"
+#include "global_options.hpp"
+#include "exception.hpp"
+
+#ifdef CASADI_WITH_THREAD
+#include <atomic>
+#endif // CASADI_WITH_THREAD
+
+namespace casadi {
+
+#ifdef CASADI_WITH_THREAD
+  struct ThreadPool::Job {
+    // Task callback
+    const Task& f;
+    // Number of tasks and chunk size
+    casadi_int n_task, chunk_size;
+    // Maximum number of participating threads
+    casadi_int max_slot;
+    // Next unclaimed task
+    std::atomic<casadi_int> next;
+    // Number of slots handed out (protected by pool mutex)
+    casadi_int n_slot;
+    // Number of helper threads currently working (protected by pool mutex)
+    casadi_int n_active;
+    // First exception raised (protected by pool mutex)
+    std::exception_ptr error;
+
+    Job(const Task& f, casadi_int n_task, casadi_int chunk_size, casadi_int max_slot)
+      : f(f), n_task(n_task), chunk_size(chunk_size), max_slot(max_slot),
+        next(0), n_slot(1), n_active(0) {
+    }
+
+    // Claim and execute chunks until no tasks remain
+    void work(casadi_int slot, std::mutex& mtx) {
+      while (true) {
+        casadi_int begin = next.fetch_add(chunk_size);
+        if (begin >= n_task) return;
+        casadi_int end = std::min(begin + chunk_size, n_task);
+        for (casadi_int i = begin; i < end; ++i) {
+          try {
+            f(i, slot);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(mtx);
+            if (!error) error = std::current_exception();
+          }
+        }
+      }
+    }
+  };
+#endif // CASADI_WITH_THREAD
+
+  ThreadPool& ThreadPool::global() {
+    static ThreadPool pool(GlobalOptions::thread_pool_size);
+    return pool;
+  }
+
+  ThreadPool::ThreadPool(casadi_int n_thread) : n_thread_(1) {
+#ifdef CASADI_WITH_THREAD
+    stop_ = false;
+    resizing_ = false;
+    n_running_ = 0;
+    start(n_thread);
+#endif // CASADI_WITH_THREAD
+  }
+
+  ThreadPool::~ThreadPool() {
+#ifdef CASADI_WITH_THREAD
+    stop();
+#endif // CASADI_WITH_THREAD
+  }
+
+  void ThreadPool::resize(casadi_int n_thread) {
+    casadi_assert(n_thread >= 0, "Number of threads must be nonnegative");
+#ifdef CASADI_WITH_THREAD
+    // Wait for running jobs, new jobs wait for the resize
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_done_.wait(lock, [this]() { return !resizing_ && n_running_ == 0;});
+      resizing_ = true;
+    }
+    stop();
+    start(n_thread);
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      resizing_ = false;
+    }
+    cv_done_.notify_all();
+#endif // CASADI_WITH_THREAD
+  }
+
+  void ThreadPool::run(casadi_int n_task, casadi_int chunk_size, casadi_int max_slot,
+      const Task& f) {
+    casadi_assert_dev(chunk_size >= 1 && max_slot >= 1);
+#ifdef CASADI_WITH_THREAD
+    // Parallel evaluation, if worthwhile
+    if (max_slot > 1 && n_task > chunk_size) {
+      Job job(f, n_task, chunk_size, max_slot);
+      // Advertise job to the workers, unless the pool is being resized
+      bool parallel;
+      {
+        std::unique_lock<std::mutex> lock(mtx_);
+        cv_done_.wait(lock, [this]() { return !resizing_;});
+        parallel = !workers_.empty();
+        if (parallel) {
+          n_running_++;
+          jobs_.push_back(&job);
+        }
+      }
+      if (parallel) {
+        cv_job_.notify_all();
+        // Take part in the job
+        job.work(0, mtx_);
+        // Wait for the helpers to finish
+        {
+          std::unique_lock<std::mutex> lock(mtx_);
+          auto it = std::find(jobs_.begin(), jobs_.end(), &job);
+          if (it != jobs_.end()) jobs_.erase(it);
+          cv_done_.wait(lock, [&job]() { return job.n_active == 0;});
+          n_running_--;
+        }
+        // Wake up a pending resize
+        cv_done_.notify_all();
+        if (job.error) std::rethrow_exception(job.error);
+        return;
+      }
+    }
+#endif // CASADI_WITH_THREAD
+    // Serial evaluation
+    for (casadi_int i = 0; i < n_task; ++i) f(i, 0);
+  }
+
+#ifdef CASADI_WITH_THREAD
+  void ThreadPool::start(casadi_int n_thread) {
+    if (n_thread == 0) n_thread = std::thread::hardware_concurrency();
+    n_thread_ = std::max(n_thread, casadi_int(1));
+    stop_ = false;
+    // The calling thread counts as one
+    for (casadi_int i = 1; i < n_thread_; ++i) {
+      workers_.emplace_back(&ThreadPool::worker, this);
+    }
+  }
+
+  void ThreadPool::stop() {
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      stop_ = true;
+    }
+    cv_job_.notify_all();
+    for (auto&& th : workers_) th.join();
+    workers_.clear();
+    n_thread_ = 1;
+  }
+
+  void ThreadPool::worker() {
+    std::unique_lock<std::mutex> lock(mtx_);
+    while (true) {
+      cv_job_.wait(lock, [this]() { return stop_ || !jobs_.empty();});
+      if (stop_) return;
+      // Join the oldest job
+      Job* job = jobs_.front();
+      casadi_int slot = job->n_slot++;
+      // Stop advertising once all slots are taken
+      if (job->n_slot >= job->max_slot) jobs_.pop_front();
+      job->n_active++;
+      lock.unlock();
+      job->work(slot, mtx_);
+      lock.lock();
+      // No unclaimed tasks remain
+      auto it = std::find(jobs_.begin(), jobs_.end(), job);
+      if (it != jobs_.end()) jobs_.erase(it);
+      if (--job->n_active == 0) cv_done_.notify_all();
+    }
+  }
+#endif // CASADI_WITH_THREAD
+
+} // namespace casadi
@@ -0,0 +1,139 @@
+/*
+ *    This file is part of CasADi.
+ *
+ *    CasADi -- A symbolic framework for dynamic optimization.
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl,
+ *                            KU Leuven. All rights reserved.
+ *    Copyright (C) 2011-2014 Greg Horn
+ *
+ *    CasADi is free software; you can redistribute it and/or
+ *    modify it under the terms of the GNU Lesser General Public
+ *    License as published by the Free Software Foundation; either
+ *    version 3 of the License, or (at your option) any later version.
+ *
+ *    CasADi is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *    Lesser General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Lesser General Public
+ *    License along with CasADi; if not, write to the Free Software
+ *    Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+
+#ifndef CASADI_THREAD_POOL_HPP
+#define CASADI_THREAD_POOL_HPP
+
+#include "casadi_common.hpp"
+#include <functional>
+#include <vector>
+
+#ifdef CASADI_WITH_THREAD
+#include <deque>
+#include <exception>
+#ifdef CASADI_WITH_THREAD_MINGW
+#include <mingw.thread.h>
+#include <mingw.mutex.h>
+#include <mingw.condition_variable.h>
+#else // CASADI_WITH_THREAD_MINGW
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif // CASADI_WITH_THREAD_MINGW
+#endif // CASADI_WITH_THREAD
+
+/// \cond INTERNAL
+
+namespace casadi {
+
+  /** \brief Persistent pool of worker threads
+
+      Jobs are split into chunks of consecutive tasks which are claimed
+      dynamically by the calling thread and by any idle worker. Each thread
+      taking part in a job is assigned a unique slot index, allowing the
+      caller to keep per-thread resources (e.g. memory objects) around
+      between jobs.
+
+      Without WITH_THREAD=ON, all tasks are executed by the calling thread.
+  */
+  class CASADI_EXPORT ThreadPool {
+  public:
+    /// Task callback: task index and slot of the executing thread
+    typedef std::function<void(casadi_int task, casadi_int slot)> Task;
+
+    /** \brief Process-wide pool, created on first use
+
+        Size taken from GlobalOptions::getThreadPoolSize() */
+    static ThreadPool& global();
+
+    /// Constructor, n_thread counts the calling thread
+    explicit ThreadPool(casadi_int n_thread);
+
+    /// Destructor, joins all workers
+    ~ThreadPool();
+
+    /// Copying is not allowed
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /// Maximum number of threads taking part in a job, including the caller
+    casadi_int size() const { return n_thread_;}
+
+    /** \brief Change the number of threads, zero means one per hardware thread
+
+        Waits for running jobs to finish, jobs submitted in the meantime wait
+        for the resize. Must not be called from within a task. */
+    void resize(casadi_int n_thread);
+
+    /** \brief Execute f(task, slot) for all task in [0, n_task)
+
+        Blocks until all tasks have completed. At most max_slot threads take
+        part, the calling thread has slot 0. The first exception thrown by
+        a task is rethrown after all tasks have finished. */
+    void run(casadi_int n_task, casadi_int chunk_size, casadi_int max_slot,
+      const Task& f);
+
+  private:
+    // Number of threads, including the caller
+    casadi_int n_thread_;
+
+#ifdef CASADI_WITH_THREAD
+    // Work shared between threads
+    struct Job;
+
+    // Start or stop the worker threads
+    void start(casadi_int n_thread);
+    void stop();
+
+    // Main loop of a worker thread
+    void worker();
+
+    // Worker threads
+    std::vector<std::thread> workers_;
+
+    // Jobs that accept more threads
+    std::deque<Job*> jobs_;
+
+    // Stop flag
+    bool stop_;
+
+    // Resize in progress
+    bool resizing_;
+
+    // Number of jobs being executed in parallel
+    casadi_int n_running_;
+
+    // Protects the above
+    std::mutex mtx_;
+
+    // Signal new jobs and finished threads respectively
+    std::condition_variable cv_job_, cv_done_;
+#endif // CASADI_WITH_THREAD
+  };
+
+} // namespace casadi
+/// \endcond
+
+#endif // CASADI_THREAD_POOL_HPP
@@ -45,6 +45,82 @@ throw CasadiException("Error in XFunction::" FNAME " for '" + this->name_ + "' "
 
 namespace casadi {
 
+  /** \brief Map from graph nodes to integers, local to a graph traversal
+
+      Open addressing with linear probing, keyed on the node address.
+      Used in place of the temp field of the nodes, so that independent
+      functions can be constructed concurrently. Values of absent nodes
+      read as zero. References are invalidated by subsequent insertions. */
+  template<typename NodeType>
+  class NodeMap {
+  public:
+    /// Constructor, with an estimate of the number of nodes
+    explicit NodeMap(size_t n=0) : n_(0) {
+      size_t cap = 16;
+      while (cap < 2*n) cap *= 2;
+      key_.resize(cap, nullptr);
+      val_.resize(cap, 0);
+    }
+
+    /// Value for a node, inserted as zero if absent
+    casadi_int& operator[](const NodeType* n) {
+      size_t i = slot(n);
+      if (key_[i]==nullptr) {
+        if (2*(n_+1) > key_.size()) {
+          grow();
+          i = slot(n);
+        }
+        key_[i] = n;
+        n_++;
+      }
+      return val_[i];
+    }
+
+    /// Value for a node, zero if absent
+    casadi_int get(const NodeType* n) const {
+      size_t i = slot(n);
+      return key_[i]==nullptr ? 0 : val_[i];
+    }
+
+    /// Number of nodes
+    size_t size() const { return n_;}
+
+  private:
+    // Slot holding a node, or the empty slot where it would be inserted
+    size_t slot(const NodeType* n) const {
+      size_t mask = key_.size() - 1;
+      size_t i = (reinterpret_cast<size_t>(n) >> 4) * static_cast<size_t>(0x9E3779B97F4A7C15ULL);
+      i = (i ^ (i >> 29)) & mask;
+      while (key_[i]!=nullptr && key_[i]!=n) i = (i + 1) & mask;
+      return i;
+    }
+
+    // Double the capacity
+    void grow() {
+      std::vector<const NodeType*> key;
+      std::vector<casadi_int> val;
+      key.swap(key_);
+      val.swap(val_);
+      key_.resize(2*key.size(), nullptr);
+      val_.resize(2*key.size(), 0);
+      for (size_t k=0; k<key.size(); ++k) {
+        if (key[k]==nullptr) continue;
+        size_t i = slot(key[k]);
+        key_[i] = key[k];
+        val_[i] = val[k];
+      }
+    }
+
+    // Keys, null for empty slots
+    std::vector<const NodeType*> key_;
+
+    // Values
+    std::vector<casadi_int> val_;
+
+    // Number of nodes
+    size_t n_;
+  };
+
   /** \brief  Internal node class for the base class of SXFunction and MXFunction
 
       (lacks a public counterpart)
@@ -85,12 +161,13 @@ namespace casadi {
 
     /** \brief  Topological sorting of the nodes based on Depth-First Search (DFS)
 
-
-    This function modifies the temp member of the nodes,
-    making it not thread-safe.
+    Progress is tracked in a map local to the caller, not in the temp member
+    of the nodes, so that sorting is thread-safe. On return, nodes that have
+    been added map to -1.
 
         \identifier{xr} */
-    static void sort_depth_first(std::stack<NodeType*>& s, std::vector<NodeType*>& nodes);
+    static void sort_depth_first(std::stack<NodeType*>& s, std::vector<NodeType*>& nodes,
+      NodeMap<NodeType>& mark);
 
     /** \brief  Construct a complete Jacobian by compression
 
@@ -336,20 +413,17 @@ namespace casadi {
                      "\nArgument " + str(i) + "(" + name_in_[i] + ") is not symbolic.");
       }
     }
-#ifdef CASADI_WITH_THREADSAFE_SYMBOLICS
-    std::lock_guard<std::mutex> lock(MatType::get_mutex_temp());
-#endif // CASADI_WITH_THREADSAFE_SYMBOLICS
-
     // Check for duplicate entries among the input expressions
     bool has_duplicates = false;
+    NodeMap<NodeType> seen;
     for (auto&& i : in_) {
-      if (i.has_duplicates()) {
-        has_duplicates = true;
-        break;
+      for (NodeType* n : DerivedType::symbolic_nodes(i)) {
+        if (seen[n]++) {
+          casadi_warning("Duplicate expression: " + n->name());
+          has_duplicates = true;
+        }
       }
     }
-    // Reset temporaries
-    for (auto&& i : in_) i.reset_input();
     // Generate error
     if (has_duplicates) {
       std::stringstream s;
@@ -393,14 +467,15 @@ namespace casadi {
 
   template<typename DerivedType, typename MatType, typename NodeType>
   void XFunction<DerivedType, MatType, NodeType>::sort_depth_first(
-      std::stack<NodeType*>& s, std::vector<NodeType*>& nodes) {
+      std::stack<NodeType*>& s, std::vector<NodeType*>& nodes, NodeMap<NodeType>& mark) {
     while (!s.empty()) {
       // Get the topmost element
       NodeType* t = s.top();
       // If the last element on the stack has not yet been added
-      if (t && t->temp>=0) {
+      casadi_int* m = t ? &mark[t] : nullptr;
+      if (m && *m>=0) {
         // Get the index of the next dependency
-        casadi_int next_dep = t->temp++;
+        casadi_int next_dep = (*m)++;
         // If there is any dependency which has not yet been added
         if (next_dep < t->n_dep()) {
           // Add dependency to stack
@@ -409,7 +484,7 @@ namespace casadi {
           // if no dependencies need to be added, we can add the node to the algorithm
           nodes.push_back(t);
           // Mark the node as found
-          t->temp = -1;
+          *m = -1;
           // Remove from stack
           s.pop();
         }
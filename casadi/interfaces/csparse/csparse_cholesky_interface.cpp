@@ -56,7 +56,6 @@ namespace casadi {
   }
 
   CsparseCholMemory::~CsparseCholMemory() {
-    if (this->S) cs_sfree(this->S);
     if (this->L) cs_nfree(this->L);
   }
 
@@ -70,7 +69,7 @@ namespace casadi {
     auto m = static_cast<CsparseCholMemory*>(mem);
 
     m->L = nullptr;
-    m->S = nullptr;
+    m->S.reset();
     m->A.nzmax = this->nnz();  // maximum number of entries
     m->A.m = this->nrow(); // number of columns
     m->A.n = this->ncol(); // number of rows
@@ -97,9 +96,11 @@ namespace casadi {
     // Set the nonzeros of the matrix
     m->A.x = const_cast<double*>(A);
 
-    // ordering and symbolic analysis
-    casadi_int order = 0; // ordering?
-    m->S = cs_schol(order, &m->A);
+    // ordering and symbolic analysis, shared between solvers with the same pattern
+    m->S = shared_symbolic<css>("csparsecholesky", [&]() {
+      casadi_int order = 0; // ordering?
+      return std::shared_ptr<css>(cs_schol(order, &m->A), cs_sfree);
+    });
     return 0;
   }
 
@@ -118,7 +119,7 @@ namespace casadi {
     }
 
     if (m->L) cs_nfree(m->L);
-    m->L = cs_chol(&m->A, m->S) ;                 // numeric Cholesky factorization
+    m->L = cs_chol(&m->A, m->S.get()) ;                 // numeric Cholesky factorization
     casadi_assert_dev(m->L!=nullptr);
     return 0;
   }
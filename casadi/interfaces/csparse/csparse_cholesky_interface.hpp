@@ -50,7 +50,7 @@ namespace casadi {
     cs A;
 
     // The symbolic factorization
-    css *S;
+    std::shared_ptr<css> S;
 
     // The numeric factorization
     csn *L;
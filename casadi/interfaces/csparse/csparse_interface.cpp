@@ -54,7 +54,6 @@ namespace casadi {
   }
 
   CsparseMemory::~CsparseMemory() {
-    if (this->S) cs_sfree(this->S);
     if (this->N) cs_nfree(this->N);
   }
 
@@ -68,7 +67,7 @@ namespace casadi {
     auto m = static_cast<CsparseMemory*>(mem);
 
     m->N = nullptr;
-    m->S = nullptr;
+    m->S.reset();
     m->A.nzmax = this->nnz();  // maximum number of entries
     m->A.m = this->nrow(); // number of rows
     m->A.n = this->ncol(); // number of columns
@@ -81,8 +80,12 @@ namespace casadi {
     m->A.x = nullptr; // numerical values, size nzmax
     m->A.nz = -1; // of entries in triplet matrix, -1 for compressed-column
 
-    // Temporary
-    m->temp_.resize(m->A.n);
+    // No pivoting yet
+    m->pinv.resize(this->nrow());
+    for (casadi_int i=0; i<this->nrow(); ++i) m->pinv[i] = i;
+
+    // Temporary, holds a panel of right-hand sides
+    m->temp_.resize(m->A.n*rhs_block_);
     return 0;
   }
 
@@ -93,9 +96,10 @@ namespace casadi {
     m->A.x = const_cast<double*>(A);
 
     // ordering and symbolic analysis
-    casadi_int order = 0; // ordering?
-    if (m->S) cs_sfree(m->S);
-    m->S = cs_sqr(order, &m->A, 0);
+    m->S = shared_symbolic<css>("csparse", [&]() {
+      casadi_int order = 0; // ordering?
+      return std::shared_ptr<css>(cs_sqr(order, &m->A, 0), cs_sfree);
+    });
     return 0;
   }
 
@@ -121,8 +125,13 @@ namespace casadi {
 
     double tol = 1e-8;
 
+    // Permute the rows such that the previous pivots end up on the diagonal,
+    // which cs_lu prefers as long as they pass the threshold test
+    const casadi_int* row = this->row();
+    for (casadi_int k=0; k<this->nnz(); ++k) m->row[k] = m->pinv[row[k]];
+
     if (m->N) cs_nfree(m->N);
-    m->N = cs_lu(&m->A, m->S, tol) ;                 // numeric LU factorization
+    m->N = cs_lu(&m->A, m->S.get(), tol) ;                 // numeric LU factorization
     if (m->N==nullptr) {
       DM temp(sp_, std::vector<double>(A, A+nnz()));
       temp = sparsify(temp);
@@ -150,30 +159,117 @@ namespace casadi {
       }
     }
     casadi_assert_dev(m->N!=nullptr);
+
+    // Pivot sequence with respect to the rows of the original matrix
+    for (casadi_int i=0; i<this->nrow(); ++i) m->pinv[i] = m->N->pinv[m->pinv[i]];
+    std::copy(m->pinv.begin(), m->pinv.end(), m->N->pinv);
     return 0;
   }
 
+  // Triangular solves as cs_lsolve, cs_ltsolve, cs_usolve and cs_utsolve,
+  // for nb right-hand sides stored row by row, i.e. x[i*nb+j] is entry i of rhs j
+  static void lsolve_block(const cs* L, double* x, casadi_int nb) {
+    const int *Lp = L->p, *Li = L->i;
+    const double* Lx = L->x;
+    for (casadi_int j=0; j<L->n; ++j) {
+      double* xj = x + j*nb;
+      for (casadi_int k=0; k<nb; ++k) xj[k] /= Lx[Lp[j]];
+      for (casadi_int p=Lp[j]+1; p<Lp[j+1]; ++p) {
+        double a = Lx[p], *xi = x + Li[p]*nb;
+        for (casadi_int k=0; k<nb; ++k) xi[k] -= a*xj[k];
+      }
+    }
+  }
+
+  static void ltsolve_block(const cs* L, double* x, casadi_int nb) {
+    const int *Lp = L->p, *Li = L->i;
+    const double* Lx = L->x;
+    for (casadi_int j=L->n-1; j>=0; --j) {
+      double* xj = x + j*nb;
+      for (casadi_int p=Lp[j]+1; p<Lp[j+1]; ++p) {
+        double a = Lx[p], *xi = x + Li[p]*nb;
+        for (casadi_int k=0; k<nb; ++k) xj[k] -= a*xi[k];
+      }
+      for (casadi_int k=0; k<nb; ++k) xj[k] /= Lx[Lp[j]];
+    }
+  }
+
+  static void usolve_block(const cs* U, double* x, casadi_int nb) {
+    const int *Up = U->p, *Ui = U->i;
+    const double* Ux = U->x;
+    for (casadi_int j=U->n-1; j>=0; --j) {
+      double* xj = x + j*nb;
+      for (casadi_int k=0; k<nb; ++k) xj[k] /= Ux[Up[j+1]-1];
+      for (casadi_int p=Up[j]; p<Up[j+1]-1; ++p) {
+        double a = Ux[p], *xi = x + Ui[p]*nb;
+        for (casadi_int k=0; k<nb; ++k) xi[k] -= a*xj[k];
+      }
+    }
+  }
+
+  static void utsolve_block(const cs* U, double* x, casadi_int nb) {
+    const int *Up = U->p, *Ui = U->i;
+    const double* Ux = U->x;
+    for (casadi_int j=0; j<U->n; ++j) {
+      double* xj = x + j*nb;
+      for (casadi_int p=Up[j]; p<Up[j+1]-1; ++p) {
+        double a = Ux[p], *xi = x + Ui[p]*nb;
+        for (casadi_int k=0; k<nb; ++k) xj[k] -= a*xi[k];
+      }
+      for (casadi_int k=0; k<nb; ++k) xj[k] /= Ux[Up[j+1]-1];
+    }
+  }
+
   int CsparseInterface::solve(void* mem, const double* A, double* x,
       casadi_int nrhs, bool tr) const {
     auto m = static_cast<CsparseMemory*>(mem);
     casadi_assert_dev(m->N!=nullptr);
+    casadi_assert_dev(m->N->U!=nullptr);
 
     double *t = &m->temp_.front();
+    casadi_int n = m->A.n;
+    const int *pinv = m->N->pinv, *q = m->S->q;
 
-    for (casadi_int k=0; k<nrhs; ++k) {
-      if (tr) {
-        cs_pvec(m->S->q, x, t, m->A.n) ;       // t = P2*b
-        casadi_assert_dev(m->N->U!=nullptr);
-        cs_utsolve(m->N->U, t) ;              // t = U'\t
-        cs_ltsolve(m->N->L, t) ;              // t = L'\t
-        cs_pvec(m->N->pinv, t, x, m->A.n) ;    // x = P1*t
+    // Process the right-hand sides in panels, stored row by row in t
+    for (casadi_int nb; nrhs>0; nrhs-=nb) {
+      nb = std::min(nrhs, rhs_block_);
+      if (nb==1) {
+        // Single right-hand side
+        if (tr) {
+          cs_pvec(q, x, t, n) ;       // t = P2*b
+          cs_utsolve(m->N->U, t) ;    // t = U'\t
+          cs_ltsolve(m->N->L, t) ;    // t = L'\t
+          cs_pvec(pinv, t, x, n) ;    // x = P1*t
+        } else {
+          cs_ipvec(pinv, x, t, n) ;   // t = P1\b
+          cs_lsolve(m->N->L, t) ;     // t = L\t
+          cs_usolve(m->N->U, t) ;     // t = U\t
+          cs_ipvec(q, t, x, n) ;      // x = P2\t
+        }
+      } else if (tr) {
+        // t = P2*b
+        for (casadi_int k=0; k<nb; ++k) {
+          for (casadi_int i=0; i<n; ++i) t[i*nb+k] = x[k*n + (q ? q[i] : i)];
+        }
+        utsolve_block(m->N->U, t, nb);  // t = U'\t
+        ltsolve_block(m->N->L, t, nb);  // t = L'\t
+        // x = P1*t
+        for (casadi_int k=0; k<nb; ++k) {
+          for (casadi_int i=0; i<n; ++i) x[k*n+i] = t[pinv[i]*nb+k];
+        }
       } else {
-        cs_ipvec(m->N->pinv, x, t, m->A.n) ;   // t = P1\b
-        cs_lsolve(m->N->L, t) ;               // t = L\t
-        cs_usolve(m->N->U, t) ;               // t = U\t
-        cs_ipvec(m->S->q, t, x, m->A.n) ;      // x = P2\t
+        // t = P1\b
+        for (casadi_int k=0; k<nb; ++k) {
+          for (casadi_int i=0; i<n; ++i) t[pinv[i]*nb+k] = x[k*n+i];
+        }
+        lsolve_block(m->N->L, t, nb);  // t = L\t
+        usolve_block(m->N->U, t, nb);  // t = U\t
+        // x = P2\t
+        for (casadi_int k=0; k<nb; ++k) {
+          for (casadi_int i=0; i<n; ++i) x[k*n + (q ? q[i] : i)] = t[i*nb+k];
+        }
       }
-      x += ncol();
+      x += nb*n;
     }
     return 0;
   }
@@ -48,8 +48,8 @@ namespace casadi {
     // The linear system CSparse form (CCS)
     cs A;
 
-    // The symbolic factorization
-    css *S;
+    // The symbolic factorization, shared between solvers with the same pattern
+    std::shared_ptr<css> S;
 
     // The numeric factorization
     csn *N;
@@ -58,6 +58,9 @@ namespace casadi {
     std::vector<double> temp_;
 
     std::vector<int> colind, row;
+
+    // Pivot sequence of the last factorization, reused as long as acceptable
+    std::vector<int> pinv;
   };
 
   /** \brief \pluginbrief{LinsolInternal,csparse}
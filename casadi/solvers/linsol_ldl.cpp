@@ -25,6 +25,7 @@
 
 #include "linsol_ldl.hpp"
 #include "casadi/core/global_options.hpp"
+#include "casadi/core/sparsity_internal.hpp"
 
 namespace casadi {
 
@@ -60,7 +61,20 @@ namespace casadi {
        "Incomplete factorization, without any fill-in"}},
       {"preordering",
        {OT_BOOL,
-       "Approximate minimal degree (AMD) preordering"}}
+       "Approximate minimal degree (AMD) preordering"}},
+      {"supernodal",
+       {OT_BOOL,
+       "Factorize supernodes of the elimination tree with dense kernels [default: true]"}},
+      {"supernodal_min_size",
+       {OT_INT,
+       "Smallest system for which the supernodal factorization is used [default: 64]"}},
+      {"parallelization",
+       {OT_STRING,
+       "Factorize independent subtrees of the elimination tree using the thread pool: "
+       "serial|thread [default: serial]"}},
+      {"parallel_min_size",
+       {OT_INT,
+       "Smallest system that is factorized in parallel [default: 1000]"}}
      }
   };
 
@@ -71,6 +85,10 @@ namespace casadi {
     // Default options
     incomplete_ = false;
     amd_ = true;
+    supernodal_ = true;
+    supernodal_min_size_ = 64;
+    parallelization_ = "serial";
+    parallel_min_size_ = 1000;
 
     // Read user options
     for (auto&& op : opts) {
@@ -78,25 +96,180 @@ namespace casadi {
         incomplete_ = op.second;
       } else if (op.first=="amd") {
         amd_ = op.second;
+      } else if (op.first=="supernodal") {
+        supernodal_ = op.second;
+      } else if (op.first=="supernodal_min_size") {
+        supernodal_min_size_ = op.second;
+      } else if (op.first=="parallelization") {
+        parallelization_ = op.second.to_string();
+      } else if (op.first=="parallel_min_size") {
+        parallel_min_size_ = op.second;
       }
     }
 
-    // Symbolic factorization
-    if (incomplete_) {
-      if (amd_) {
-        // Incomplete LDL^T, AMD permutation
-        p_ = sp_.amd();
-        std::vector<casadi_int> tmp;
-        Sparsity Aperm = sp_.sub(p_, p_, tmp);
-        sp_Lt_ = triu(Aperm, false);  // no fill-in
+    // Symbolic factorization, shared between solvers with the same pattern and options
+    bool sn = !incomplete_ && supernodal_ && nrow() >= supernodal_min_size_;
+    std::string key = std::string("ldl") + (incomplete_ ? ":incomplete" : "")
+      + (amd_ ? ":amd" : "") + (sn ? ":supernodal" : "");
+    symbolic_ = shared_symbolic<Symbolic>(key, [&]() {
+      if (incomplete_) {
+        if (amd_) {
+          // Incomplete LDL^T, AMD permutation
+          p_ = sp_.amd();
+          std::vector<casadi_int> tmp;
+          Sparsity Aperm = sp_.sub(p_, p_, tmp);
+          sp_Lt_ = triu(Aperm, false);  // no fill-in
+        } else {
+          p_ = range(sp_.size1());  // no reordering
+          sp_Lt_ = triu(sp_, false);  // no fill-in
+        }
       } else {
-        p_ = range(sp_.size1());  // no reordering
-        sp_Lt_ = triu(sp_, false);  // no fill-in
+        // Regular LDL^T
+        sp_Lt_ = sp_.ldl(p_, amd_);
+        // Supernodal factorization for larger systems
+        if (sn) init_supernodes();
+      }
+      return std::make_shared<Symbolic>(Symbolic{p_, sp_Lt_, sn_});
+    });
+    p_ = symbolic_->p;
+    sp_Lt_ = symbolic_->sp_Lt;
+    sn_ = symbolic_->sn;
+
+    // Check parallelization strategy, fall back to serial if not compiled in
+    casadi_assert(parallelization_=="serial" || parallelization_=="thread",
+      "Unknown parallelization '" + parallelization_ + "', expected serial|thread");
+#ifndef CASADI_WITH_THREAD
+    if (parallelization_=="thread") {
+      casadi_warning("CasADi was not compiled with WITH_THREAD=ON. "
+                     "Falling back to serial factorization.");
+      parallelization_ = "serial";
+    }
+#endif // CASADI_WITH_THREAD
+
+    // Only the supernodal factorization is parallelized
+    parallel_ = parallelization_=="thread" && !sn_.empty() && nrow() >= parallel_min_size_;
+    if (parallel_) init_schedule();
+  }
+
+  void LinsolLdl::init_schedule() {
+    casadi_int ns = sn_[1];
+    const casadi_int* upd_ptr = get_ptr(sn_) + 2 + 3*(ns + 1) + sn_[2 + 2*ns + 1];
+    const casadi_int* upd = upd_ptr + ns + 1;
+    // A supernode is updated by its descendants only
+    std::vector<casadi_int> level(ns, 0);
+    for (casadi_int s=0; s<ns; ++s) {
+      for (casadi_int u=upd_ptr[s]; u<upd_ptr[s+1]; ++u) {
+        level[s] = std::max(level[s], level[upd[3*u]] + 1);
       }
-    } else {
-      // Regular LDL^T
-      sp_Lt_ = sp_.ldl(p_, amd_);
     }
+    level_schedule(level, sn_level_ptr_, sn_level_ind_);
+  }
+
+  void LinsolLdl::init_supernodes() {
+    casadi_int n = nrow();
+    sn_.clear();
+    // Elimination tree of the permuted matrix, same as that of L+L'
+    std::vector<casadi_int> parent(n), post(n), iw(3*n);
+    SparsityInternal::etree(sp_Lt_, get_ptr(parent), get_ptr(iw), false);
+    // Postorder the elimination tree, making the supernodes contiguous
+    SparsityInternal::postorder(get_ptr(parent), n, get_ptr(post), get_ptr(iw));
+    if (post!=range(n)) {
+      // Same fill-in, recalculate the symbolic factorization
+      p_ = vector_slice(p_, post);
+      std::vector<casadi_int> tmp;
+      sp_Lt_ = sp_.sub(p_, p_, tmp).ldl(tmp, false);
+      SparsityInternal::etree(sp_Lt_, get_ptr(parent), get_ptr(iw), false);
+    }
+    const casadi_int *lt_colind = sp_Lt_.colind(), *lt_row = sp_Lt_.row();
+    // Column counts of L, including the diagonal
+    std::vector<casadi_int> cc(n, 1);
+    for (casadi_int k=0; k<sp_Lt_.nnz(); ++k) cc[lt_row[k]]++;
+    // Merge chains in the elimination tree, allowing explicit zeros in narrow supernodes
+    std::vector<casadi_int> sn_col(1, 0);
+    casadi_int nz = 0;
+    for (casadi_int c=0; c<n; ++c) {
+      nz += cc[c];
+      if (c+1<n && parent[c]==c+1) {
+        casadi_int w = c + 2 - sn_col.back(), m = w + cc[c+1] - 1;
+        casadi_int tot = w*m - (w*(w-1))/2, zeros = tot - nz - cc[c+1];
+        if (w<=4 || (w<=16 && 5*zeros<=4*tot) || (w<=48 && 10*zeros<=tot)
+            || 20*zeros<=tot) continue;
+      }
+      sn_col.push_back(c + 1);
+      nz = 0;
+    }
+    casadi_int ns = sn_col.size() - 1;
+    // Fall back to the scalar factorization if the supernodes are mostly single columns
+    if (4*ns > 3*n) return;
+    // Supernode of each column
+    std::vector<casadi_int> sn_of(n);
+    for (casadi_int s=0; s<ns; ++s) {
+      for (casadi_int c=sn_col[s]; c<sn_col[s+1]; ++c) sn_of[c] = s;
+    }
+    // Rows and dense storage of each supernode
+    Sparsity sp_L = sp_Lt_.T();
+    const casadi_int *l_colind = sp_L.colind(), *l_row = sp_L.row();
+    std::vector<casadi_int> sn_row(1, 0), sn_val(1, 0), row;
+    for (casadi_int s=0; s<ns; ++s) {
+      casadi_int last = sn_col[s+1] - 1;
+      for (casadi_int c=sn_col[s]; c<=last; ++c) row.push_back(c);
+      for (casadi_int k=l_colind[last]; k<l_colind[last+1]; ++k) row.push_back(l_row[k]);
+      sn_row.push_back(row.size());
+      sn_val.push_back(sn_val.back()
+        + (sn_row[s+1] - sn_row[s]) * (sn_col[s+1] - sn_col[s]));
+    }
+    // Position of L(r, c) in the dense storage
+    auto ind = [&](casadi_int r, casadi_int c) {
+      casadi_int s = sn_of[c];
+      auto r_begin = row.begin() + sn_row[s], r_end = row.begin() + sn_row[s+1];
+      auto it = std::lower_bound(r_begin, r_end, r);
+      casadi_assert_dev(it!=r_end && *it==r);
+      return sn_val[s] + (c - sn_col[s]) * (sn_row[s+1] - sn_row[s]) + (it - r_begin);
+    };
+    // Updates between supernodes, grouped by the target supernode
+    std::vector<std::vector<casadi_int>> upd(ns);
+    for (casadi_int s=0; s<ns; ++s) {
+      casadi_int i = sn_col[s+1] - sn_col[s], m = sn_row[s+1] - sn_row[s];
+      while (i<m) {
+        casadi_int t = sn_of[row[sn_row[s] + i]], p1 = i;
+        while (i<m && sn_of[row[sn_row[s] + i]]==t) i++;
+        upd[t].insert(upd[t].end(), {s, p1, i});
+      }
+    }
+    // Assemble the encoding, cf. casadi_ldl_sn
+    sn_ = {n, ns};
+    sn_.insert(sn_.end(), sn_col.begin(), sn_col.end());
+    sn_.insert(sn_.end(), sn_row.begin(), sn_row.end());
+    sn_.insert(sn_.end(), sn_val.begin(), sn_val.end());
+    sn_.insert(sn_.end(), row.begin(), row.end());
+    casadi_int nupd = 0;
+    for (casadi_int s=0; s<=ns; ++s) {
+      sn_.push_back(nupd);
+      if (s<ns) nupd += upd[s].size() / 3;
+    }
+    for (auto&& u : upd) sn_.insert(sn_.end(), u.begin(), u.end());
+    // Upper triangular part of A, as in casadi_ldl
+    std::vector<casadi_int> pinv(n);
+    for (casadi_int c=0; c<n; ++c) pinv[p_[c]] = c;
+    const casadi_int *a_colind = sp_.colind(), *a_row = sp_.row();
+    sn_.push_back(sp_.nnz());
+    for (casadi_int c1=0; c1<n; ++c1) {
+      casadi_int c = pinv[c1];
+      for (casadi_int k=a_colind[c1]; k<a_colind[c1+1]; ++k) {
+        casadi_int r = pinv[a_row[k]];
+        sn_.push_back(r<=c ? ind(c, r) : -1);
+      }
+    }
+    sn_.push_back(sp_Lt_.nnz());
+    for (casadi_int c=0; c<n; ++c) {
+      for (casadi_int k=lt_colind[c]; k<lt_colind[c+1]; ++k) sn_.push_back(ind(c, lt_row[k]));
+    }
+  }
+
+  casadi_int LinsolLdl::sn_nnz() const {
+    if (sn_.empty()) return 0;
+    casadi_int ns = sn_[1];
+    return sn_[2 + 3*ns + 2];
   }
 
   int LinsolLdl::init_mem(void* mem) const {
@@ -107,7 +280,9 @@ namespace casadi {
     casadi_int nrow = this->nrow();
     m->d.resize(nrow);
     m->l.resize(sp_Lt_.nnz());
-    m->w.resize(nrow);
+    m->w.resize(nrow*rhs_block_);
+    m->v.resize(sn_nnz());
+    m->iw.resize(sn_.empty() ? 0 : nrow);
 
     return 0;
   }
@@ -118,7 +293,25 @@ namespace casadi {
 
   int LinsolLdl::nfact(void* mem, const double* A) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
-    casadi_ldl(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    if (sn_.empty()) {
+      casadi_ldl(sp_, A, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    } else if (parallel_) {
+      // Work vectors for each thread
+      casadi_int n = nrow(), n_slot = max_slots();
+      if (m->w.size() < n_slot*n) m->w.resize(n_slot*n);
+      if (m->iw.size() < n_slot*n) m->iw.resize(n_slot*n);
+      double *v = get_ptr(m->v), *d = get_ptr(m->d), *w = get_ptr(m->w);
+      casadi_int* iw = get_ptr(m->iw);
+      // Supernodes of the same level are independent
+      casadi_ldl_sn_assemble(get_ptr(sn_), A, v);
+      run_levels(sn_level_ptr_, sn_level_ind_, n_slot, [&](casadi_int s, casadi_int slot) {
+        casadi_ldl_sn_node(get_ptr(sn_), s, d, v, w + slot*n, iw + slot*n);
+      });
+      casadi_ldl_sn_lt(get_ptr(sn_), v, get_ptr(m->l));
+    } else {
+      casadi_ldl_sn(get_ptr(sn_), A, get_ptr(m->l), get_ptr(m->d), get_ptr(m->v),
+                    get_ptr(m->w), get_ptr(m->iw));
+    }
     for (double d : m->d) {
       if (d==0) casadi_warning("LDL factorization has zeros in D");
     }
@@ -127,7 +320,8 @@ namespace casadi {
 
   int LinsolLdl::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolLdlMemory*>(mem);
-    casadi_ldl_solve(x, nrhs, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_), get_ptr(m->w));
+    casadi_ldl_solve_block(x, nrhs, sp_Lt_, get_ptr(m->l), get_ptr(m->d), get_ptr(p_),
+                           get_ptr(m->w), rhs_block_);
     return 0;
   }
 
@@ -156,34 +350,52 @@ namespace casadi {
     std::string sp_Lt = g.sparsity(sp_Lt_);
     std::string p = g.constant(p_);
 
+    // Number of right-hand sides per panel in the solve
+    casadi_int nb = std::max(std::min(nrhs, rhs_block_), casadi_int(1));
+
     // Place in block to avoid conflicts caused by local variables
     g << "{\n";
+    if (!sn_.empty()) {
+      // Supernode storage at the start of the work vector, before w is shadowed
+      g << "casadi_real *v = w;\n";
+    }
     g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
     g << "casadi_real lt[" << sp_Lt_.nnz() << "], "
          "d[" << nrow() << "], "
-         "w[" << nrow() << "];\n";
+         "w[" << nrow()*nb << "];\n";
 
     // Factorize
-    g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    if (sn_.empty()) {
+      g << g.ldl(sp, A, sp_Lt, "lt", "d", p, "w") << "\n";
+    } else {
+      g << "casadi_int iw[" << nrow() << "];\n";
+      g << g.ldl_sn(g.constant(sn_), A, "lt", "d", "v", "w", "iw") << "\n";
+    }
 
     // Solve
-    g << g.ldl_solve(x, nrhs, sp_Lt, "lt", "d", p, "w") << "\n";
+    g << g.ldl_solve_block(x, nrhs, sp_Lt, "lt", "d", p, "w", nb) << "\n";
 
     // End of block
     g << "}\n";
   }
 
   LinsolLdl::LinsolLdl(DeserializingStream& s) : LinsolInternal(s) {
-    s.version("LinsolLdl", 1);
+    int version = s.version("LinsolLdl", 1, 3);
     s.unpack("LinsolLdl::p", p_);
     s.unpack("LinsolLdl::sp_Lt", sp_Lt_);
+    if (version >= 2) s.unpack("LinsolLdl::sn", sn_);
+    parallel_ = false;
+    if (version >= 3) s.unpack("LinsolLdl::parallel", parallel_);
+    if (parallel_) init_schedule();
   }
 
   void LinsolLdl::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LinsolLdl", 1);
+    s.version("LinsolLdl", 3);
     s.pack("LinsolLdl::p", p_);
     s.pack("LinsolLdl::sp_Lt", sp_Lt_);
+    s.pack("LinsolLdl::sn", sn_);
+    s.pack("LinsolLdl::parallel", parallel_);
   }
 
 } // namespace casadi
@@ -42,6 +42,9 @@
 namespace casadi {
   struct CASADI_LINSOL_LDL_EXPORT LinsolLdlMemory : public LinsolMemory {
     std::vector<double> l, d, w;
+    // Dense supernode storage
+    std::vector<double> v;
+    std::vector<casadi_int> iw;
   };
 
   /** \brief \pluginbrief{LinsolInternal,ldl}
@@ -93,6 +96,9 @@ namespace casadi {
     void generate(CodeGenerator& g, const std::string& A, const std::string& x,
                   casadi_int nrhs, bool tr) const override;
 
+    /// The supernode storage of the generated code is placed in the work vector
+    size_t generate_sz_w() const override { return sn_nnz();}
+
     /// Number of negative eigenvalues
     casadi_int neig(void* mem, const double* A) const override;
 
@@ -112,11 +118,40 @@ namespace casadi {
     std::vector<casadi_int> p_;
     Sparsity sp_Lt_;
 
+    // Supernode partition for the supernodal factorization, empty if not used
+    std::vector<casadi_int> sn_;
+
+    // Detect supernodes in the symbolic factorization
+    void init_supernodes();
+
+    // Size of the dense supernode storage
+    casadi_int sn_nnz() const;
+
+    // Result of the symbolic factorization, shared via shared_symbolic
+    struct Symbolic {
+      std::vector<casadi_int> p;
+      Sparsity sp_Lt;
+      std::vector<casadi_int> sn;
+    };
+    std::shared_ptr<Symbolic> symbolic_;
+
+    // Supernodes grouped by level in the elimination tree, for parallel factorization
+    std::vector<casadi_int> sn_level_ptr_, sn_level_ind_;
+
+    // Group the supernodes by level
+    void init_schedule();
+
     ///@{
     // Options
-    bool incomplete_, amd_;
+    bool incomplete_, amd_, supernodal_;
+    casadi_int supernodal_min_size_;
+    std::string parallelization_;
+    casadi_int parallel_min_size_;
     ///@}
 
+    // Factorize independent supernodes in parallel
+    bool parallel_;
+
     /** \brief Serialize an object without type information */
     void serialize_body(SerializingStream &s) const override;
 
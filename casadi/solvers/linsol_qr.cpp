@@ -60,7 +60,14 @@ namespace casadi {
         "Minimum R entry before singularity is declared [1e-12]"}},
       {"cache",
        {OT_DOUBLE,
-        "Amount of factorisations to remember (thread-local) [0]"}}
+        "Amount of factorisations to remember (thread-local) [0]"}},
+      {"parallelization",
+       {OT_STRING,
+        "Factorize independent subtrees of the column elimination tree using the thread pool: "
+        "serial|thread [serial]"}},
+      {"parallel_min_size",
+       {OT_INT,
+        "Smallest system that is factorized in parallel [1000]"}}
      }
   };
 
@@ -71,16 +78,55 @@ namespace casadi {
     // Read options
     eps_ = 1e-12;
     n_cache_ = 0;
+    parallelization_ = "serial";
+    parallel_min_size_ = 1000;
     for (auto&& op : opts) {
       if (op.first=="eps") {
         eps_ = op.second;
       } else if (op.first=="cache") {
         n_cache_ = op.second;
+      } else if (op.first=="parallelization") {
+        parallelization_ = op.second.to_string();
+      } else if (op.first=="parallel_min_size") {
+        parallel_min_size_ = op.second;
       }
     }
 
-    // Symbolic factorization
-    sp_.qr_sparse(sp_v_, sp_r_, prinv_, pc_);
+    // Symbolic factorization, shared between solvers with the same pattern
+    symbolic_ = shared_symbolic<Symbolic>("qr", [&]() {
+      auto r = std::make_shared<Symbolic>();
+      sp_.qr_sparse(r->sp_v, r->sp_r, r->prinv, r->pc);
+      return r;
+    });
+    sp_v_ = symbolic_->sp_v;
+    sp_r_ = symbolic_->sp_r;
+    prinv_ = symbolic_->prinv;
+    pc_ = symbolic_->pc;
+
+    // Check parallelization strategy, fall back to serial if not compiled in
+    casadi_assert(parallelization_=="serial" || parallelization_=="thread",
+      "Unknown parallelization '" + parallelization_ + "', expected serial|thread");
+#ifndef CASADI_WITH_THREAD
+    if (parallelization_=="thread") {
+      casadi_warning("CasADi was not compiled with WITH_THREAD=ON. "
+                     "Falling back to serial factorization.");
+      parallelization_ = "serial";
+    }
+#endif // CASADI_WITH_THREAD
+    parallel_ = parallelization_=="thread" && ncol() >= parallel_min_size_;
+    if (parallel_) init_schedule();
+  }
+
+  void LinsolQr::init_schedule() {
+    // Column c depends on the columns r<c in the pattern of R(:,c)
+    const casadi_int *r_colind = sp_r_.colind(), *r_row = sp_r_.row();
+    std::vector<casadi_int> level(ncol(), 0);
+    for (casadi_int c=0; c<ncol(); ++c) {
+      for (casadi_int k=r_colind[c]; k<r_colind[c+1] && r_row[k]<c; ++k) {
+        level[c] = std::max(level[c], level[r_row[k]] + 1);
+      }
+    }
+    level_schedule(level, level_ptr_, level_ind_);
   }
 
   void LinsolQr::finalize() {
@@ -96,7 +142,7 @@ namespace casadi {
     m->v.resize(sp_v_.nnz());
     m->r.resize(sp_r_.nnz());
     m->beta.resize(ncol());
-    m->w.resize(nrow() + ncol());
+    m->w.resize(std::max(nrow() + ncol(), solve_block_sz()));
 
     m->cache.resize(cache_stride_*n_cache_);
     m->cache_loc.resize(n_cache_, -1);
@@ -126,9 +172,22 @@ namespace casadi {
     }
 
     // Cache miss -> compute result
-    casadi_qr(sp_, A, get_ptr(m->w),
-              sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
-              get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_));
+    if (parallel_) {
+      // Zeroed work vector for each thread
+      casadi_int nrow_ext = sp_v_.size1(), n_slot = max_slots();
+      if (m->w.size() < n_slot*nrow_ext) m->w.resize(n_slot*nrow_ext);
+      std::fill(m->w.begin(), m->w.begin() + n_slot*nrow_ext, 0.);
+      // Columns of the same level are independent
+      double *w = get_ptr(m->w), *v = get_ptr(m->v), *r = get_ptr(m->r), *beta = get_ptr(m->beta);
+      run_levels(level_ptr_, level_ind_, n_slot, [&](casadi_int c, casadi_int slot) {
+        casadi_qr_col(sp_, A, w + slot*nrow_ext, sp_v_, v, sp_r_, r, beta,
+                      get_ptr(prinv_), get_ptr(pc_), c);
+      });
+    } else {
+      casadi_qr(sp_, A, get_ptr(m->w),
+                sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
+                get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_));
+    }
     // Check singularity
     double rmin;
     casadi_int irmin, nullity;
@@ -154,11 +213,16 @@ namespace casadi {
     return 0;
   }
 
+  casadi_int LinsolQr::solve_block_sz(casadi_int nb) const {
+    return (std::max(sp_v_.size1(), ncol()) + 1) * nb;
+  }
+
   int LinsolQr::solve(void* mem, const double* A, double* x, casadi_int nrhs, bool tr) const {
     auto m = static_cast<LinsolQrMemory*>(mem);
-    casadi_qr_solve(x, nrhs, tr,
-                    sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
-                    get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w));
+    casadi_qr_solve_block(x, nrhs, tr,
+                          sp_v_, get_ptr(m->v), sp_r_, get_ptr(m->r),
+                          get_ptr(m->beta), get_ptr(prinv_), get_ptr(pc_), get_ptr(m->w),
+                          rhs_block_);
     return 0;
   }
 
@@ -171,13 +235,16 @@ namespace casadi {
     std::string sp_v = g.sparsity(sp_v_);
     std::string sp_r = g.sparsity(sp_r_);
 
+    // Number of right-hand sides per panel in the solve
+    casadi_int nb = std::max(std::min(nrhs, rhs_block_), casadi_int(1));
+
     // Place in block to avoid conflicts caused by local variables
     g << "{\n";
     g.comment("FIXME(@jaeandersson): Memory allocation can be avoided");
     g << "casadi_real v[" << sp_v_.nnz() << "], "
          "r[" << sp_r_.nnz() << "], "
          "beta[" << ncol() << "], "
-         "w[" << nrow() + ncol() << "];\n";
+         "w[" << std::max(nrow() + ncol(), solve_block_sz(nb)) << "];\n";
 
     if (n_cache_) {
       g << "casadi_real *c;\n";
@@ -211,14 +278,14 @@ namespace casadi {
     }
 
     // Solve
-    g << g.qr_solve(x, nrhs, tr, sp_v, "v", sp_r, "r", "beta", prinv, pc, "w") << "\n";
+    g << g.qr_solve_block(x, nrhs, tr, sp_v, "v", sp_r, "r", "beta", prinv, pc, "w", nb) << "\n";
 
     // End of block
     g << "}\n";
   }
 
   LinsolQr::LinsolQr(DeserializingStream& s) : LinsolInternal(s) {
-    int version = s.version("LinsolQr", 1, 2);
+    int version = s.version("LinsolQr", 1, 3);
     s.unpack("LinsolQr::prinv", prinv_);
     s.unpack("LinsolQr::pc", pc_);
     s.unpack("LinsolQr::sp_v", sp_v_);
@@ -229,17 +296,21 @@ namespace casadi {
     } else {
       n_cache_ = 1;
     }
+    parallel_ = false;
+    if (version>2) s.unpack("LinsolQr::parallel", parallel_);
+    if (parallel_) init_schedule();
   }
 
   void LinsolQr::serialize_body(SerializingStream &s) const {
     LinsolInternal::serialize_body(s);
-    s.version("LinsolQr", 2);
+    s.version("LinsolQr", 3);
     s.pack("LinsolQr::prinv", prinv_);
     s.pack("LinsolQr::pc", pc_);
     s.pack("LinsolQr::sp_v", sp_v_);
     s.pack("LinsolQr::sp_r", sp_r_);
     s.pack("LinsolQr::eps", eps_);
     s.pack("LinsolQr::n_cache", n_cache_);
+    s.pack("LinsolQr::parallel", parallel_);
   }
 
 } // namespace casadi
@@ -114,6 +114,25 @@ namespace casadi {
     Sparsity sp_v_, sp_r_;
     double eps_;
 
+    /// Result of the symbolic factorization, shared via shared_symbolic
+    struct Symbolic {
+      std::vector<casadi_int> prinv, pc;
+      Sparsity sp_v, sp_r;
+    };
+    std::shared_ptr<Symbolic> symbolic_;
+
+    /// Work vector size of the blocked solve with panels of nb right-hand sides
+    casadi_int solve_block_sz(casadi_int nb=rhs_block_) const;
+
+    ///@{
+    /// Parallel factorization of independent columns
+    std::string parallelization_;
+    casadi_int parallel_min_size_;
+    bool parallel_;
+    std::vector<casadi_int> level_ptr_, level_ind_;
+    void init_schedule();
+    ///@}
+
     /// Cache size
     casadi_int n_cache_;
     casadi_int cache_stride_;
@@ -79,7 +79,11 @@ namespace casadi {
         "Printed numbers are 0-based indices into the vector of [simple bounds;linear bounds]"}},
       {"min_lam",
        {OT_DOUBLE,
-        "Smallest multiplier treated as inactive for the initial active set [0]."}}
+        "Smallest multiplier treated as inactive for the initial active set [0]."}},
+      {"partial_fact",
+       {OT_BOOL,
+        "Update the QR factorization of the KKT matrix incrementally "
+        "when the active set changes [true]."}}
      }
   };
 
@@ -115,6 +119,8 @@ namespace casadi {
         p_.dual_inf_tol = op.second;
       } else if (op.first=="min_lam") {
         p_.min_lam = op.second;
+      } else if (op.first=="partial_fact") {
+        p_.partial_fact = op.second;
       } else if (op.first=="print_iter") {
         print_iter_ = op.second;
       } else if (op.first=="print_header") {
@@ -177,6 +183,7 @@ namespace casadi {
     if (Conic::init_mem(mem)) return 1;
     auto m = static_cast<QrqpMemory*>(mem);
     m->return_status = "";
+    m->d.n_partial_fact = 0;
     return 0;
   }
 
@@ -248,6 +255,7 @@ namespace casadi {
         m->return_status = "Printing error";
         break;
     }
+    d_qp.iter_count = d.iter;
     // Get solution
     casadi_copy(&d.f, 1, d_qp.f);
     casadi_copy(d.z, nx_, d_qp.x);
@@ -284,6 +292,7 @@ namespace casadi {
     g << "p.min_lam = " << p_.min_lam << ";\n";
     g << "p.constr_viol_tol = " << p_.constr_viol_tol << ";\n";
     g << "p.dual_inf_tol = " << p_.dual_inf_tol << ";\n";
+    g << "p.partial_fact = " << p_.partial_fact << ";\n";
 
     // Setup data structure
     g << "d.prob = &p;\n";
@@ -348,11 +357,12 @@ namespace casadi {
     Dict stats = Conic::get_stats(mem);
     auto m = static_cast<QrqpMemory*>(mem);
     stats["return_status"] = m->return_status;
+    stats["n_partial_fact"] = m->d.n_partial_fact;
     return stats;
   }
 
   Qrqp::Qrqp(DeserializingStream& s) : Conic(s) {
-    s.version("Qrqp", 1);
+    int version = s.version("Qrqp", 1, 2);
     s.unpack("Qrqp::AT", AT_);
     s.unpack("Qrqp::kkt", kkt_);
     s.unpack("Qrqp::sp_v", sp_v_);
@@ -368,12 +378,13 @@ namespace casadi {
     s.unpack("Qrqp::min_lam", p_.min_lam);
     s.unpack("Qrqp::constr_viol_tol", p_.constr_viol_tol);
     s.unpack("Qrqp::dual_inf_tol", p_.dual_inf_tol);
+    if (version >= 2) s.unpack("Qrqp::partial_fact", p_.partial_fact);
   }
 
   void Qrqp::serialize_body(SerializingStream &s) const {
     Conic::serialize_body(s);
 
-    s.version("Qrqp", 1);
+    s.version("Qrqp", 2);
     s.pack("Qrqp::AT", AT_);
     s.pack("Qrqp::kkt", kkt_);
     s.pack("Qrqp::sp_v", sp_v_);
@@ -388,6 +399,7 @@ namespace casadi {
     s.pack("Qrqp::min_lam", p_.min_lam);
     s.pack("Qrqp::constr_viol_tol", p_.constr_viol_tol);
     s.pack("Qrqp::dual_inf_tol", p_.dual_inf_tol);
+    s.pack("Qrqp::partial_fact", p_.partial_fact);
   }
 
 } // namespace casadi
@@ -27,6 +27,7 @@
 #include "casadi/core/casadi_misc.hpp"
 #include "casadi/core/casadi_meta.hpp"
 #include "casadi/core/casadi_logger.hpp"
+#include "casadi/core/thread_pool.hpp"
 #include <fstream>
 
 // Set default object file suffix
@@ -65,6 +66,9 @@ namespace casadi {
     if (cleanup_) {
       if (remove(bin_name_.c_str())) casadi_warning("Failed to remove " + bin_name_);
       if (remove(obj_name_.c_str())) casadi_warning("Failed to remove " + obj_name_);
+      for (const std::string& s : extra_obj_names_) {
+        if (remove(s.c_str())) casadi_warning("Failed to remove " + s);
+      }
       for (const std::string& s : extra_suffixes_) {
         std::string name = base_name_+s;
         remove(name.c_str());
@@ -125,6 +129,14 @@ namespace casadi {
         "This is desired for thread-safety. "
         "This behaviour may defeat caching compiler wrappers. "
         "Default: true"}},
+      {"extra_sources",
+       {OT_STRINGVECTOR,
+        "Additional source files, compiled separately and linked into the same library. "
+        "Default: None"}},
+      {"jobs",
+       {OT_INT,
+        "Maximum number of sources compiled concurrently, "
+        "limited by the size of the global thread pool. Default: 0 (no limit)"}},
      }
   };
 
@@ -141,6 +153,8 @@ namespace casadi {
 
     std::vector<std::string> compiler_flags;
     std::vector<std::string> linker_flags;
+    std::vector<std::string> extra_sources;
+    casadi_int jobs = 0;
     std::string suffix = OBJECT_FILE_SUFFIX;
 
 #ifdef _WIN32
@@ -188,6 +202,10 @@ namespace casadi {
         bare_name = op.second.to_string();
       } else if (op.first=="temp_suffix") {
         temp_suffix = op.second;
+      } else if (op.first=="extra_sources") {
+        extra_sources = op.second;
+      } else if (op.first=="jobs") {
+        jobs = op.second;
       }
     }
 
@@ -211,24 +229,45 @@ namespace casadi {
     }
 #endif // _WIN32
 
-    // Construct the compiler command
-    std::stringstream cccmd;
-    cccmd << compiler;
-    for (auto i=compiler_flags.begin(); i!=compiler_flags.end(); ++i) {
-      cccmd << " " << *i;
+    // Object files for the additional sources
+    extra_obj_names_.clear();
+    for (casadi_int k=0; k<extra_sources.size(); ++k) {
+      extra_obj_names_.push_back(
+        std::string(obj_name_.begin(), obj_name_.end()-suffix.size())
+        + "_" + str(k) + suffix);
     }
-    cccmd << " " << compiler_setup;
 
-    // C/C++ source file
-    cccmd << " " << name_;
+    // Construct the compiler commands
+    std::vector<std::string> cccmds;
+    for (casadi_int k=-1; k<static_cast<casadi_int>(extra_sources.size()); ++k) {
+      std::stringstream cccmd;
+      cccmd << compiler;
+      for (auto i=compiler_flags.begin(); i!=compiler_flags.end(); ++i) {
+        cccmd << " " << *i;
+      }
+      cccmd << " " << compiler_setup;
+
+      // C/C++ source file
+      cccmd << " " << (k<0 ? name_ : extra_sources[k]);
 
-    // Temporary object file
-    cccmd << " " + compiler_output_flag << obj_name_;
+      // Temporary object file
+      cccmd << " " + compiler_output_flag << (k<0 ? obj_name_ : extra_obj_names_[k]);
+      cccmds.push_back(cccmd.str());
+    }
 
-    // Compile into an object
-    if (verbose_) casadi_message("calling \"" + cccmd.str() + "\"");
-    if (system(cccmd.str().c_str())) {
-      casadi_error("Compilation failed. Tried \"" + cccmd.str() + "\"");
+    // Compile into objects, independent sources concurrently
+    // Messages are printed here, not from the workers
+    if (verbose_) {
+      for (const std::string& cccmd : cccmds) casadi_message("calling \"" + cccmd + "\"");
+    }
+    if (jobs<=0) jobs = cccmds.size();
+    std::vector<int> failed(cccmds.size(), 0);
+    ThreadPool::global().run(cccmds.size(), 1, jobs,
+      [&](casadi_int k, casadi_int slot) {
+        failed[k] = system(cccmds[k].c_str()) != 0;
+      });
+    for (casadi_int k=0; k<cccmds.size(); ++k) {
+      if (failed[k]) casadi_error("Compilation failed. Tried \"" + cccmds[k] + "\"");
     }
 
     // Link step
@@ -236,7 +275,9 @@ namespace casadi {
     ldcmd << linker;
 
     // Temporary file
-    ldcmd << " " << obj_name_ << " " + linker_output_flag + bin_name_;
+    ldcmd << " " << obj_name_;
+    for (const std::string& s : extra_obj_names_) ldcmd << " " << s;
+    ldcmd << " " + linker_output_flag + bin_name_;
 
     // Add flags
     for (auto i=linker_flags.begin(); i!=linker_flags.end(); ++i) {
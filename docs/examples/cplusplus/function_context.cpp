@@ -0,0 +1,94 @@
+/*
+ *    MIT No Attribution
+ *
+ *    Copyright (C) 2010-2023 Joel Andersson, Joris Gillis, Moritz Diehl, KU Leuven.
+ *
+ *    Permission is hereby granted, free of charge, to any person obtaining a copy of this
+ *    software and associated documentation files (the "Software"), to deal in the Software
+ *    without restriction, including without limitation the rights to use, copy, modify,
+ *    merge, publish, distribute, sublicense, and/or sell copies of the Software, and to
+ *    permit persons to whom the Software is furnished to do so.
+ *
+ *    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ *    INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS FOR A
+ *    PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ *    HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION
+ *    OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+ *    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ *
+ */
+
+
+/** \brief Allocation-free repeated evaluation with FunctionContext
+ * Evaluates a function many times from caller-owned buffers and checks
+ * that the results are right and that no heap allocations take place.
+ */
+
+#include "casadi/casadi.hpp"
+#include <cmath>
+#include <cstdlib>
+#include <new>
+
+using namespace casadi;
+
+// Count the heap allocations of the process
+static long n_alloc = 0;
+
+void* operator new(std::size_t sz) {
+  ++n_alloc;
+  void* p = std::malloc(sz ? sz : 1);
+  if (!p) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept {
+  std::free(p);
+}
+
+int main() {
+  SX x = SX::sym("x", 2);
+  SX p = SX::sym("p");
+  Function f("f", {x, p}, {sin(x(0))*p, x(0)*x(1) + p*p});
+
+  // Caller-owned buffers
+  double x_val[2], p_val, r0, r1;
+  const double* arg[2] = {x_val, &p_val};
+  double* res[2] = {&r0, &r1};
+
+  // Context of this thread, created on first use
+  FunctionContext& ctx = FunctionContext::local(f);
+
+  long n_alloc_before = n_alloc;
+  double max_err = 0;
+  for (int k=0; k<1000; ++k) {
+    x_val[0] = 0.001*k;
+    x_val[1] = 2 - 0.002*k;
+    p_val = 0.5 + 0.001*k;
+    if (FunctionContext::local(f).eval(arg, res)) return 1;
+    max_err = std::fmax(max_err, std::fabs(r0 - std::sin(x_val[0])*p_val));
+    max_err = std::fmax(max_err, std::fabs(r1 - (x_val[0]*x_val[1] + p_val*p_val)));
+  }
+  long n_alloc_loop = n_alloc - n_alloc_before;
+
+  std::cout << "max error: " << max_err << std::endl;
+  std::cout << "allocations in 1000 evaluations: " << n_alloc_loop << std::endl;
+  if (max_err > 1e-14 || n_alloc_loop != 0) return 1;
+  if (&FunctionContext::local(f) != &ctx) return 1;
+
+  // The cache holds at most local_capacity contexts per thread
+  std::vector<Function> g;
+  for (casadi_int i=0; i<FunctionContext::local_capacity; ++i) {
+    g.push_back(Function("g" + str(i), {x}, {x*static_cast<double>(i)}));
+    FunctionContext::local(g.back());
+  }
+  std::cout << "references to f after using other functions: " << f.getCount() << std::endl;
+  if (f.getCount() != 1) return 1;
+
+  // Contexts can also be dropped explicitly
+  FunctionContext::local(f);
+  FunctionContext::clear_local();
+  std::cout << "references to f after clear_local: " << f.getCount() << std::endl;
+  if (f.getCount() != 1) return 1;
+
+  return 0;
+}
@@ -4119,6 +4119,7 @@ def PyFunction(name, obj, inputs, outputs, opts={}):
 #ifndef SWIGPYTHON
 %ignore FunctionBuffer;
 %ignore _function_buffer_eval;
+%ignore FunctionContext;
 #endif
 
 %include <casadi/core/function.hpp>
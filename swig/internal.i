@@ -6025,7 +6025,7 @@
 %exception casadi::DeserializingStream::DeserializingStream(std::istream &in_s) {
  CATCH_OR_NOT(INTERNAL_MSG() $action) 
 }
-%exception casadi::FileDeserializer::FileDeserializer(const std::string &fname) {
+%exception casadi::FileDeserializer::FileDeserializer(const std::string &fname, const Dict &opts=Dict()) {
  CATCH_OR_NOT(INTERNAL_MSG() $action) 
 }
 %exception casadi::FileSerializer::FileSerializer(const std::string &fname, const Dict &opts=Dict()) {
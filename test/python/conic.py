@@ -952,6 +952,37 @@ class ConicTests(casadiTestCase):
     
     
 
+  @requires_conic("qrqp")
+  def test_qrqp_partial_fact(self):
+    # Banded Hessian and box constraints: many active-set changes
+    n = 12
+    H = DM.eye(n)
+    for i in range(n-1):
+      H[i,i+1] = 0.4
+      H[i+1,i] = 0.4
+    a0 = DM.ones(1,n)
+    a1 = DM([[i%3 for i in range(n)]])
+    g0 = DM([(3. if i%2 else -3.)*(1+0.1*i) for i in range(n)])
+    g1 = DM([(-3. if i%2 else 1.)*(1+0.1*i) for i in range(n)])
+    # Second case: redundant linear constraints trigger singular_step
+    for A, g, lba, uba, singular in [(a0, g0, [-2], [2], False),
+                                     (vertcat(a0,a1,2*a1), g1, [-5,-1,-2], [5,1,2], True)]:
+      solver_in = {"h":H,"g":g,"a":A,"lbx":-1,"ubx":1,"lba":lba,"uba":uba}
+      res = []
+      for partial_fact in [False, True]:
+        solver = conic("solver","qrqp",{"h":H.sparsity(),"a":A.sparsity()},
+          {"partial_fact":partial_fact,"print_iter":False,"print_header":False})
+        res.append((solver(**solver_in), solver.stats()))
+      (out_full, stats_full), (out_part, stats_part) = res
+      self.assertTrue(stats_part["success"])
+      self.assertEqual(stats_full["n_partial_fact"], 0)
+      self.assertTrue(stats_part["n_partial_fact"]>1)
+      # A singular step discards the factorization, forcing a full one
+      self.assertEqual(stats_part["n_partial_fact"]<stats_part["iter_count"], singular)
+      self.assertEqual(stats_full["iter_count"], stats_part["iter_count"])
+      for k in ["x","lam_x","lam_a","cost"]:
+        self.checkarray(out_part[k],out_full[k],k,digits=12)
+
   @requires_conic("hpipm")
   @requires_conic("qpoases")
   def test_hpipm(self):
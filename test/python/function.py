@@ -629,6 +629,96 @@ class Functiontests(casadiTestCase):
     self.checkfunction_light(fun.map(4,"thread",2),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
     self.checkfunction_light(fun.map(4,"thread",5),fun.map(4),inputs=[hcat(X_[:4]),hcat(Y_[:4]),hcat(Z_[:4]),hcat(V_[:4])])
 
+  def test_map_thread_pool(self):
+    x = SX.sym("x")
+    y = SX.sym("y",2)
+    fun = Function("f",[x,y],[sin(y*x),x**2])
+
+    X_ = DM(np.random.random((1,50)))
+    Y_ = DM(np.random.random((2,50)))
+
+    for n in [1,2,3,0]:
+      GlobalOptions.setThreadPoolSize(n)
+      self.assertEqual(GlobalOptions.getThreadPoolSize(),n)
+      F = fun.map(50,"thread")
+      # Repeated calls reuse the worker threads and memory objects
+      for i in range(3):
+        self.checkfunction_light(F,fun.map(50),inputs=[X_,Y_])
+
+  def test_map_batch(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p")
+    y = x
+    for i in range(5):
+      y = sin(y)*x[0]+fmax(y[::-1],p)
+    fun = Function("f",[x,p],[y,sumsqr(y)])
+    X = MX.sym("x",3)
+    P = MX.sym("p")
+    # Reference without batched evaluation
+    funm = Function("f",[X,P],fun(X,P))
+
+    for n in [1,8,13]:
+      X_ = DM(np.random.random((3,n)))
+      P_ = DM(np.random.random((1,n)))
+      self.checkfunction_light(fun.map(n),funm.map(n),inputs=[X_,P_])
+      self.checkfunction_light(Function.deserialize(fun.map(n).serialize()),funm.map(n),inputs=[X_,P_])
+      # Missing inputs and outputs
+      self.checkarray(fun.map(n)(0,P_)[1],funm.map(n)(0,P_)[1])
+
+  def test_bytecode(self):
+    x = SX.sym("x",3)
+    y = SX.sym("y")
+    g = Function("g",[y],[sin(y)*2+y])
+    e = x
+    for i in range(3):
+      e = e[::-1]*x[0]+x - 3.5 + sq(e)/2 + 2*e - e[1] + exp(-sq(e))*cos(x) + fmin(e,1) + g(e[2])
+    f = Function("f",[x],[e,x[0]*x[1]+x[2],2-x,x/3],{"bytecode":True})
+    fref = Function("f",[x],[e,x[0]*x[1]+x[2],2-x,x/3],{"bytecode":False})
+    inputs = [DM([0.1,0.2,0.3])]
+    self.checkfunction_light(f,fref,inputs=inputs)
+    self.checkfunction_light(Function.deserialize(f.serialize()),fref,inputs=inputs)
+
+  def test_native(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p")
+    e = x
+    for i in range(3):
+      e = e[::-1]*x[0]-x/p + sq(e)/2 + 2*e - sqrt(fabs(e)) - e[1] + exp(-sq(e))*cos(x) + fmin(e,1)
+    f = Function("f",[x,p],[e,-x*p],{"native":True})
+    fref = Function("f",[x,p],[e,-x*p],{"bytecode":False})
+    inputs = [DM([0.1,0.2,0.3]),DM(0.7)]
+    self.checkfunction_light(f,fref,inputs=inputs)
+    self.checkfunction_light(Function.deserialize(f.serialize()),fref,inputs=inputs)
+    # Missing inputs and outputs
+    self.checkarray(f(0,inputs[1])[0],fref(0,inputs[1])[0])
+
+  def test_numeric_ad(self):
+    x = SX.sym("x",3)
+    p = SX.sym("p")
+    e = x
+    for i in range(3):
+      e = sin(e)*p + e[::-1]*x[0] + fmax(e,p) + sq(e)/(1+exp(-e))
+    f = Function("f",[x,p],[e,dot(e,x),x[1]],{"numeric_ad":True})
+    fref = Function("f",[x,p],[e,dot(e,x),x[1]])
+    inputs = [DM([0.1,0.4,-0.3]),DM(0.7)]
+    self.checkfunction_light(f,fref,inputs=inputs)
+    self.assertEqual(f.forward(2).class_name(),"SXTape")
+    self.assertEqual(f.reverse(2).class_name(),"SXTape")
+    for F,Fref in [(f.forward(2),fref.forward(2)),(f.reverse(2),fref.reverse(2))]:
+      inputs_der = [DM.rand(F.sparsity_in(i)) for i in range(F.n_in())]
+      self.checkfunction_light(F,Fref,inputs=inputs_der)
+      self.checkfunction_light(Function.deserialize(F.serialize()),Fref,inputs=inputs_der)
+      self.check_codegen(F,inputs=inputs_der)
+    J = f.jacobian()
+    Jref = fref.jacobian()
+    self.checkfunction_light(J,Jref,inputs=[DM.rand(J.sparsity_in(i)) for i in range(J.n_in())])
+    # Second order derivatives, through the symbolic equivalent of the tape
+    X = MX.sym("x",3)
+    P = MX.sym("p")
+    H = Function("H",[X,P],[hessian(f(X,P)[1],X)[0]])
+    Href = Function("H",[X,P],[hessian(fref(X,P)[1],X)[0]])
+    self.checkfunction_light(H,Href,inputs=inputs)
+
   @memory_heavy()
   def test_mapsum(self):
     x = SX.sym("x")
@@ -1616,6 +1706,94 @@ class Functiontests(casadiTestCase):
       self.checkarray(J,J_ref,digits=5)
       self.assertTrue(J.sparsity()==J_ref.sparsity())
 
+  def test_hvp(self):
+    x = SX.sym("x",4)
+    y = SX.sym("y",2)
+    a = sin(x[0])*x[1]*y[0]+dot(x,x)*y[1]
+    b = vertcat(x[2]*x[3],cos(x[0])*y[1])
+    f = Function("f",[x,y],[a,b],["x","y"],["a","b"])
+
+    xm = MX.sym("x",4)
+    ym = MX.sym("y",2)
+    g = Function("g",[xm,ym],f(xm,ym),["x","y"],["a","b"])
+
+    x0 = DM([0.1,0.2,0.3,0.4])
+    y0 = DM([0.5,0.6])
+    lam_a = DM(1.5)
+    lam_b = DM([0.7,-0.3])
+    z = vertcat(x,y)
+    H = Function("H",[x,y],[hessian(lam_a*a+dot(lam_b,b),z)[0]])(x0,y0)
+    for nvec in [1,3]:
+      V = DM.rand(4,nvec)
+      W = DM.rand(2,nvec)
+      ref = mtimes(H,vertcat(V,W))
+      for F in [f,g]:
+        Hv = F.hvp(nvec)
+        self.assertEqual(Hv.name_in(),["x","y","adj_a","adj_b","fwd_x","fwd_y"])
+        inputs = [x0,y0,lam_a,lam_b,V,W]
+        [hx,hy] = Hv(*inputs)
+        self.checkarray(vertcat(hx,hy),ref)
+        self.check_codegen(Hv,inputs=inputs)
+
+  def test_hessian_edge_pushing(self):
+    x = SX.sym("x",5)
+    y = SX.sym("y",2)
+    a = sin(x[0])*x[1]*y[0]+dot(x,x)*y[1]+x[2]/x[3]+x[4]**x[0]+exp(x[1]*x[1])
+    b = vertcat(x[2]*x[3],cos(x[0])*y[1],sqrt(x[4])*atan2(x[2],x[1]))
+    f = Function("f",[x,y],[a,b],["x","y"],["a","b"])
+
+    xm = MX.sym("x",5)
+    ym = MX.sym("y",2)
+    g = Function("g",[xm,ym],f(xm,ym),["x","y"],["a","b"])
+
+    inputs = [DM([0.1,0.2,0.3,0.4,0.5]),DM([0.5,0.6]),DM(1.5),DM([0.7,-0.3,0.9])]
+    lam_a = SX.sym("lam_a")
+    lam_b = SX.sym("lam_b",3)
+    for iind,z in enumerate([x,y]):
+      H_ref = Function("H_ref",[x,y,lam_a,lam_b],[hessian(lam_a*a+dot(lam_b,b),z)[0]])
+      for F in [f,g]:
+        H = F.hessian(iind)
+        self.assertEqual(H.name_in(),["x","y","adj_a","adj_b"])
+        self.checkfunction_light(H,H_ref,inputs=inputs)
+      # Edge pushing finds the same pattern as symbolic differentiation
+      self.assertTrue(f.hessian(iind).sparsity_out(0)==H_ref.sparsity_out(0))
+
+  def test_callback_jacobian_compressed_fd(self):
+    n = 8
+    calls = []
+
+    class Fun(Callback):
+
+        def __init__(self):
+          Callback.__init__(self)
+          self.construct("Fun", {"enable_fd":True,"fd_method":"forward","fd_options":{"h": 1e-7,"h_iter":False}})
+        def get_n_in(self): return 1
+        def get_n_out(self): return 1
+        def get_sparsity_in(self,i): return Sparsity.dense(n,1)
+        def get_sparsity_out(self,i): return Sparsity.dense(n,1)
+
+        def eval(self,arg):
+          x = arg[0]
+          calls.append(x)
+          return [x**2+vertcat(0,x[:-1])]
+
+        def has_jac_sparsity(self,oind,iind): return True
+
+        def get_jac_sparsity(self,oind,iind,symmetric):
+          return Sparsity.diag(n)+Sparsity.band(n,-1)
+
+    f = Fun()
+    J = f.jacobian()
+    x0 = DM(range(1,n+1))
+    y0 = f(x0)
+    calls[:] = []
+    Jv = J(x0,y0)
+    # Lower bidiagonal pattern, two perturbations instead of n
+    self.assertEqual(len(calls),2)
+    J_ref = sparsify(diag(2*x0)+DM(Sparsity.band(n,-1),1))
+    self.checkarray(Jv,J_ref,digits=5)
+    self.assertTrue(Jv.sparsity()==J_ref.sparsity())
+
 
   @requires_nlpsol("ipopt")
   def test_common_specific_options(self):
@@ -2178,6 +2356,25 @@ class Functiontests(casadiTestCase):
         self.assertTrue("-1e-07," in out[0] or "-1e-007," in out[0] )
         self.assertTrue("1e-07," in out[0] or "1e-007," in out[0] )
 
+  def test_fd_parallelization(self):
+    xs = SX.sym("x",5)
+    ys = SX.sym("y",2)
+    e = [sin(xs)*ys[0],dot(xs,xs)+ys[1]]
+    x = MX.sym("x",5)
+    y = MX.sym("y",2)
+    inputs = [DM([1.1,1.2,1.3,1.4,1.5]),DM([0.3,0.7])]
+    only_fd = {"enable_fd":True,"enable_forward":False,"enable_reverse":False,"enable_jacobian":False}
+    for fd_method in ["forward","central","smoothing"]:
+      J_ref = None
+      for p in ["serial","thread","openmp"]:
+        opts = {"fd_method":fd_method,"fd_options":{"parallelization":p}}
+        opts.update(only_fd)
+        f = Function("f",[xs,ys],e,opts)
+        J = Function("J",[x,y],[jacobian(vertcat(*f(x,y)),vertcat(x,y))])
+        if J_ref is None:
+          J_ref = J
+        self.checkfunction_light(J,J_ref,inputs=inputs)
+
   @requires_nlpsol("ipopt")
   @requiresPlugin(Importer,"shell")
   def test_inherit_jit_options(self):
@@ -2644,6 +2841,31 @@ class Functiontests(casadiTestCase):
 
     self.assertEqual(buf.ret(), 0)
 
+  def test_functioncontext_local(self):
+    x = MX.sym("x",2)
+    # More functions than the per-thread cache holds contexts for
+    fs = [Function("f%d" % i,[x],[sin(x)*i]) for i in range(FunctionContext.local_capacity+5)]
+    x_ = np.array([0.3,0.7])
+
+    # Cycling through all of them evicts every context before it is used again
+    for rep in range(3):
+      for i,f in enumerate(fs):
+        ctx = FunctionContext.local(f)
+        self.assertEqual(ctx.function().name(), f.name())
+        r_ = np.zeros(2)
+        ctx.set_arg(0, memoryview(x_))
+        ctx.set_res(0, memoryview(r_))
+        self.assertEqual(ctx.eval(), 0)
+        self.checkarray(r_, np.sin(x_)*i)
+
+    FunctionContext.clear_local()
+    ctx = FunctionContext.local(fs[1])
+    r_ = np.zeros(2)
+    ctx.set_arg(0, memoryview(x_))
+    ctx.set_res(0, memoryview(r_))
+    self.assertEqual(ctx.eval(), 0)
+    self.checkarray(r_, np.sin(x_))
+
   @requires_conic("osqp")
   @requiresPlugin(Importer,"shell")
   def test_jit_buffer_eval(self):
@@ -2802,6 +3024,49 @@ class Functiontests(casadiTestCase):
       with self.assertOutput([],["jit_tmp"]):
         g = Function.load('f.casadi')
 
+  @requiresPlugin(Importer,"shell")
+  def test_jit_cache(self):
+    import shutil
+    cache = "jit_cache_test"
+    shutil.rmtree(cache, ignore_errors=True)
+    x = MX.sym("x")
+    opts = {"jit":True, "compiler": "shell", "jit_cache_directory": cache, "verbose": True}
+    with self.assertOutput(["JIT cache miss"],["JIT cache hit"]):
+      f = Function('f',[x],[(x-3)**2],opts)
+    with self.assertOutput(["JIT cache hit"],["JIT cache miss"]):
+      g = Function('f',[x],[(x-3)**2],opts)
+    self.checkfunction_light(f, g, inputs=[1.5])
+    # Different code, different entry
+    with self.assertOutput(["JIT cache miss"],[]):
+      h = Function('f',[x],[(x-2)**2],opts)
+    self.assertEqual(len([n for n in os.listdir(cache) if n.endswith(".key")]),2)
+    # Size bound evicts older entries
+    opts["jit_cache_size"] = 1
+    with self.assertOutput(["JIT cache miss"],[]):
+      h = Function('f',[x],[(x-1)**2],opts)
+    self.assertTrue(len([n for n in os.listdir(cache) if n.endswith(".key")])<=1)
+
+  @requiresPlugin(Importer,"shell")
+  def test_jit_units(self):
+    x = SX.sym("x",3)
+    y = x
+    for i in range(20):
+      y = sin(y)*x[0]+cos(y[::-1])
+    f = Function('f',[x],[y])
+    F = Function('F',[x],[f(x)*x[1],f(2*x)])
+    inputs = [DM([1.1,1.3,1.7])]
+    for unit_size in [5,50]:
+      g = Function('f',[x],[y],{"jit":True,"compiler":"shell","jit_unit_size":unit_size,"jit_options":{"jobs":2}})
+      self.checkfunction_light(f, g, inputs=inputs)
+      # Dependencies in separate units
+      X = MX.sym("x",3)
+      G = Function('G',[X],[F(X)],{"jit":True,"compiler":"shell","jit_unit_size":unit_size})
+      self.checkfunction_light(F, G, inputs=inputs)
+
+    cg = CodeGenerator("units",{"unit_size":10})
+    cg.add(F)
+    cg.generate()
+    self.assertTrue(len(cg.units())>1)
 
   def test_map_get_function(self):
     x = MX.sym("x")
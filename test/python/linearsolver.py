@@ -509,6 +509,84 @@ class LinearSolverTests(casadiTestCase):
     self.check_codegen(f, inputs=[As[0]])
     self.check_serialize(f, inputs=[As[0]])
 
+  def test_ldl_supernodal(self):
+    # KKT-like system: 2D Laplacian with a few dense-ish constraint rows
+    N = 15
+    n = N*N
+    H = DM(Sparsity.diag(n),4.5)
+    for i in range(N):
+      for j in range(N):
+        k = i*N+j
+        if j+1<N: H[k,k+1] = H[k+1,k] = -1
+        if i+1<N: H[k,k+N] = H[k+N,k] = -1
+    J = DM(5,n)
+    for q in range(5):
+      for t in range(4): J[q,(q*37+t*101)%n] = 1.0+t
+    A = blockcat([[H,J.T],[J,-1e-3*DM.eye(5)]])
+    b = DM.rand(n+5,2)
+
+    As = MX.sym("A",A.sparsity())
+    bs = MX.sym("b",b.sparsity())
+    ref = solve(A,b,"ldl",{"supernodal":False})
+    for opts in [{},{"supernodal_min_size":0}]:
+      f = Function('f',[As,bs],[solve(As,bs,"ldl",opts)])
+      self.checkarray(f(A,b),ref,digits=10)
+      self.checkarray(mtimes(A,f(A,b)),b,digits=10)
+      self.check_codegen(f,inputs=[A,b])
+      self.check_serialize(f,inputs=[A,b])
+
+  def test_parallel_factorization(self):
+    N = 12
+    A = DM(Sparsity.diag(N*N),4.5)
+    for i in range(N):
+      for j in range(N):
+        k = i*N+j
+        if j+1<N: A[k,k+1] = A[k+1,k] = -1
+        if i+1<N: A[k,k+N] = A[k+N,k] = -1
+    b = DM.rand(N*N,3)
+
+    As = MX.sym("A",A.sparsity())
+    bs = MX.sym("b",b.sparsity())
+    for Solver in ["ldl","qr"]:
+      ref = solve(A,b,Solver)
+      f = Function('f',[As,bs],[solve(As,bs,Solver,{"parallelization":"thread","parallel_min_size":0})])
+      self.checkarray(f(A,b),ref,digits=12)
+      self.check_serialize(f,inputs=[A,b])
+
+  def test_shared_symbolic(self):
+    A = DM([[0,2,0,1],[1,0,3,0],[0,1,0,4],[5,0,1,0]])
+    b = DM.rand(4,2)
+    for Solver in ["ldl","qr","csparse"]:
+      if not has_linsol(Solver): continue
+      # Solvers with the same pattern share the symbolic factorization
+      l1 = Linsol("l1",Solver,A.sparsity())
+      l2 = Linsol("l2",Solver,A.sparsity())
+      self.checkarray(l2.solve(A+A.T,b),l1.solve(A+A.T,b),digits=12)
+      if Solver=="ldl": continue
+      # Refactorization with other pivots needed
+      for k in range(4):
+        Ak = A+0
+        Ak[k,(k+1)%4] = 0
+        self.checkarray(mtimes(Ak,l2.solve(Ak,b)),b,digits=10)
+
+  def test_multiple_rhs(self):
+    A = DM(Sparsity.banded(20,2),1)+4*DM.eye(20)
+    A[3,17] = A[17,3] = 0.5
+    b = DM.rand(20,13)
+    As = MX.sym("A",A.sparsity())
+    bs = MX.sym("b",b.sparsity())
+    for Solver in ["ldl","qr","csparse"]:
+      if not has_linsol(Solver): continue
+      for tr in ([False] if Solver=="ldl" else [False,True]):
+        l = Linsol("l",Solver,A.sparsity())
+        # Panels of right-hand sides give the same result as one at a time
+        x = l.solve(A,b,tr)
+        for k in range(b.shape[1]):
+          self.checkarray(x[:,k],l.solve(A,b[:,k],tr),digits=12)
+      if Solver=="csparse": continue
+      f = Function('f',[As,bs],[solve(As,bs,Solver)])
+      self.check_codegen(f,inputs=[A,b])
+
   @memory_heavy()
   def test_thread_safety(self):
     x = MX.sym('x')
@@ -99,6 +99,67 @@ class SerializeTests(casadiTestCase):
         
         print(e,r)
         check_equal(e,r)
-      
+
+  def test_binary(self):
+    x = SX.sym("x",3)
+    p = MX.sym("p",Sparsity.lower(3))
+    f = Function("f",[x],[sin(x)*x[0]+DM([1e-300,2,numpy.pi])])
+    g = Function("g",[p],[mtimes(p,f(p[:,0])),p.nz[2]])
+
+    for F in [f,g]:
+      inputs = [DM.rand(F.sparsity_in(i)) for i in range(F.n_in())]
+      for opts in [{"binary":True},{"binary":True,"debug":True},{}]:
+        F.save("binary.casadi",opts)
+        F2 = Function.load("binary.casadi")
+        self.checkfunction_light(F2,F,inputs=inputs)
+
+    # Binary files are smaller than their text counterparts
+    g.save("text.casadi")
+    g.save("binary.casadi",{"binary":True})
+    self.assertTrue(os.path.getsize("binary.casadi")<os.path.getsize("text.casadi"))
+
+  def test_text_v3(self):
+    # Files written by the text-only serializer (protocol version 3)
+    dir = os.path.join("..","data","serialize_v3")
+    for name in ["f","g"]:
+      f = Function.load(os.path.join(dir,name+".casadi"))
+      inp = f.generate_in(os.path.join(dir,name+"_in.txt"))
+      outp_ref = f.generate_out(os.path.join(dir,name+"_out.txt"))
+      outp = f.call(inp)
+      for o,o_ref in zip(outp,outp_ref):
+        self.checkarray(o,o_ref,digits=15,failmessage=name)
+
+      # Round trip through the binary encoding
+      f.save("binary.casadi",{"binary":True})
+      self.checkfunction_light(Function.load("binary.casadi"),f,inputs=inp)
+
+  def test_mmap_lazy_cache(self):
+    x = MX.sym("x",3)
+    f = Function("f",[x],[sin(x)*x[0]])
+    J = f.jacobian()
+    f = Function("f",[x],[sin(x)*x[0]],{"cache": {J.name(): J}})
+    inputs = [DM([1.1,2.2,3.3])]
+
+    for save_opts in [{"binary":True},{}]:
+      f.save("lazy.casadi",save_opts)
+      for load_opts in [{"mmap":True},{}]:
+        f2 = Function.load("lazy.casadi",load_opts)
+        self.checkfunction_light(f2,f,inputs=inputs)
+        # Cache entry deserialized on demand
+        J2 = f2.jacobian()
+        self.assertEqual(J2.name(),J.name())
+        self.checkfunction_light(J2,J,inputs=inputs+[DM.zeros(3,1)])
+        # Saving again keeps the cache entries
+        f2.save("lazy2.casadi",save_opts)
+        f3 = Function.load("lazy2.casadi")
+        self.checkfunction_light(f3.jacobian(),J,inputs=inputs+[DM.zeros(3,1)])
+
+    # Entries stored under another name are not used, as without lazy loading
+    g = Function("g",[x,MX.sym("out",3)],[DM.zeros(3,3)])
+    f = Function("f",[x],[sin(x)*x[0]],{"cache": {J.name(): g}})
+    f.save("lazy.casadi",{"binary":True})
+    f2 = Function.load("lazy.casadi")
+    self.checkfunction_light(f2.jacobian(),J,inputs=inputs+[DM.zeros(3,1)])
+
 if __name__ == '__main__':
     unittest.main()
@@ -479,6 +479,96 @@ class Sparsitytests(casadiTestCase):
 
     self.assertTrue(DM(J.sparsity_out(0))[:X.nnz(),:].sparsity()==Sparsity.diag(100))
 
+  def test_jacsparsity_wide(self):
+    x = SX.sym("x",300)
+    y = vertcat(x[1:]*x[:-1],sin(x[0])+x[150],x[::7].T @ x[::7])
+    sp_ref = []
+    GlobalOptions.setHierarchicalSparsity(False)
+    for w in [64, 256, 100]:
+      GlobalOptions.setSparsityWidth(w)
+      self.assertEqual(GlobalOptions.getSparsityWidth()%64,0)
+      for fwd in [True, False]:
+        g = Function("g",[x],[y,x[:40]**2],{"ad_weight_sp": 0 if fwd else 1})
+        sp = [g.jac_sparsity(i,0) for i in range(2)]
+        if not sp_ref:
+          sp_ref = sp
+        for a,b in zip(sp,sp_ref):
+          self.assertTrue(a==b)
+    GlobalOptions.setSparsityWidth(256)
+    GlobalOptions.setHierarchicalSparsity(True)
+
+  def test_coloring_orderings(self):
+    numpy.random.seed(0)
+    A = self.randDM(60,40,0.1).sparsity()
+    for ordering in range(4):
+      D = A.uni_coloring(A.T,1000000,ordering)
+      self.assertEqual(D.nnz(),A.size2())
+      # Columns of the same color are structurally orthogonal
+      self.assertTrue(numpy.all(numpy.array(mtimes(DM.ones(A),DM.ones(D)))<=1))
+    H = self.randDM(40,40,0.1,symm=True).sparsity()
+    for ordering in range(4):
+      D = H.star_coloring(ordering)
+      self.assertEqual(D.nnz(),H.size2())
+      [v,c] = D.get_triplet()
+      color = dict(zip(v,c))
+      [r,k] = H.get_triplet()
+      for i,j in zip(r,k):
+        if i!=j: self.assertTrue(color[i]!=color[j])
+
+  def test_jacsparsity_parallel(self):
+    GlobalOptions.setHierarchicalSparsity(False)
+    for X in [SX, MX]:
+      x = X.sym("x",1000)
+      y = vertcat(x[1:]*x[:-1],sin(x[0])+x[500])
+      sp_ref = []
+      for flag in [False, True]:
+        GlobalOptions.setParallelSparsity(flag)
+        for fwd in [True, False]:
+          f = Function("f",[x],[y],{"ad_weight_sp": 0 if fwd else 1})
+          sp = f.jac_sparsity(0,0)
+          if not sp_ref:
+            sp_ref = [sp]
+          self.assertTrue(sp==sp_ref[0])
+    GlobalOptions.setParallelSparsity(True)
+    GlobalOptions.setHierarchicalSparsity(True)
+
+  def test_sparsity_database(self):
+    import os
+    import shutil
+    import tempfile
+    d = tempfile.mkdtemp()
+    try:
+      GlobalOptions.setSparsityDatabase(d)
+      for X in [SX, MX]:
+        x = X.sym("x",100)
+        y = vertcat(x[1:]*x[:-1],sin(x[0])+x[50])
+        sp_ref = Function("f",[x],[y]).jac_sparsity(0,0)
+        n_entries = len(os.listdir(d))
+        self.assertTrue(n_entries>0)
+        # A structurally identical instance reads the stored pattern
+        f = Function("f",[x],[y])
+        self.assertTrue(f.jac_sparsity(0,0)==sp_ref)
+        self.assertEqual(len(os.listdir(d)),n_entries)
+        # Names are not part of the key
+        z = X.sym("z",100)
+        g = Function("g",[z],[vertcat(z[1:]*z[:-1],sin(z[0])+z[50])],["a"],["b"])
+        self.assertTrue(g.jac_sparsity(0,0)==sp_ref)
+        self.assertEqual(len(os.listdir(d)),n_entries)
+        # Colorings are stored as well
+        J = f.jacobian()
+        self.checkfunction_light(J,Function("f",[x],[y]).jacobian(),inputs=[DM.rand(100),DM.rand(100)])
+    finally:
+      GlobalOptions.setSparsityDatabase("")
+      shutil.rmtree(d)
+    # Entries that cannot be written are skipped
+    GlobalOptions.setSparsityDatabase(os.path.join(d,"missing","dir"))
+    try:
+      x = SX.sym("x",3)
+      f = Function("f",[x],[x[0]*x[2]])
+      self.assertEqual(f.jac_sparsity(0,0).nnz(),2)
+    finally:
+      GlobalOptions.setSparsityDatabase("")
+
   @memory_heavy()
   def test_jacsparsityHierarchicalSymm(self):
     GlobalOptions.setHierarchicalSparsity(False)